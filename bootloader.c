@@ -0,0 +1,347 @@
+//Boot block image: built alone by the "bootloader" configuration, linked
+//below BL_APP_START. Everything is polled, interrupts stay off.
+
+#include <xc.h>
+#include "constants.h"
+#include "config.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "nrf_boot.h"
+#include "bootloader.h"
+
+#ifndef R_RX_PL_WID
+#define R_RX_PL_WID     0x60
+#endif
+#define RX_EMPTY        0x01    // FIFO_STATUS
+#define TX_FULL         0x20
+
+//Timer0 runs 16 bit from Fosc/4 like the application's, 4.096ms per overflow
+#define BL_OVERFLOWS(ms)    ((unsigned int)((ms) * 1000UL / 4096) + 1)
+
+//The application's vectors, BL_APP_START + 0x08 and + 0x18
+asm("PSECT intcode");
+asm("goto 0x1008");
+asm("PSECT intcodelo");
+asm("goto 0x1018");
+
+unsigned char bl_buf[MAX_PAYLOAD];
+unsigned char bl_row[BL_ROW];
+unsigned int bl_next;       // image offset expected next
+unsigned char bl_state;
+
+const unsigned char bl_radioTable[] = {
+    CONFIG,         0x0C,
+    EN_AA,          0x01,
+    EN_RXADDR,      0x01,
+    SETUP_RETR,     0x33,
+    RF_CH,          NRF_DEFAULT_CHANNEL,
+    RF_SETUP,       NRF_DEFAULT_SETUP,
+    FEATURE,        0x06,   // dynamic payload length, ACK payloads
+    DYNPD,          0x01,
+    STATUS,         RX_DR | TX_DS | MAX_RT,
+};
+
+void bl_setup(void) {
+    OSCCONbits.IRCF = 0b111;
+    OSCCONbits.SCS = 0b00;
+    OSCTUNEbits.PLLEN = 0b1;
+
+    T0CONbits.T0CS = 0;
+    T0CONbits.PSA = 1;
+    T0CONbits.T08BIT = 0;
+    T0CONbits.TMR0ON = 1;
+
+    ANCON0 = 0b00000000;
+    ANCON1 = 0b11111000;
+
+    TRIS_CE = OUTPUT;
+    TRIS_CSN = OUTPUT;
+    TRIS_IRQ = INPUT;
+    TRIS_SCK = OUTPUT;
+    TRIS_MISO = INPUT;
+    TRIS_MOSI = OUTPUT;
+}
+
+void bl_wait(unsigned int overflows) {
+    INTCONbits.TMR0IF = 0;
+    while (overflows) {
+        if (INTCONbits.TMR0IF) {
+            INTCONbits.TMR0IF = 0;
+            overflows--;
+        }
+    }
+}
+
+////                            Data EEPROM                                 ////
+
+unsigned char bl_eeRead(unsigned int addr) {
+    EEADRH = addr >> 8;
+    EEADR = addr & 0xFF;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.CFGS = 0;
+    EECON1bits.RD = 1;
+    return EEDATA;
+}
+
+//Runs the unlock sequence for whatever EECON1 is set up for. The CPU stalls
+//through flash erases/writes, data EEPROM writes carry on in the background.
+void bl_unlock(void) {
+    EECON1bits.WREN = 1;
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;
+    EECON1bits.WREN = 0;
+}
+
+void bl_eeWrite(unsigned int addr, unsigned char value) {
+    while (EECON1bits.WR);
+    EEADRH = addr >> 8;
+    EEADR = addr & 0xFF;
+    EEDATA = value;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.CFGS = 0;
+    bl_unlock();
+    while (EECON1bits.WR);
+}
+
+////                            Flash                                       ////
+
+void bl_tblptr(unsigned int addr) {
+    TBLPTRU = 0;
+    TBLPTRH = addr >> 8;
+    TBLPTRL = addr & 0xFF;
+}
+
+//Erases and programs one row from bl_row. The CPU is stalled for both, but
+//the radio keeps receiving into its FIFO and acking with the ACK payloads
+//already queued, so the updater keeps streaming while the row is written.
+void bl_writeRow(unsigned int addr) {
+    unsigned char i;
+
+    bl_tblptr(addr);
+    EECON1bits.EEPGD = 1;
+    EECON1bits.CFGS = 0;
+    EECON1bits.FREE = 1;
+    bl_unlock();
+
+    for (i=0; i<BL_ROW; i++) {
+        TABLAT = bl_row[i];
+        asm("TBLWT*+");
+    }
+    asm("TBLRD*-");     //back inside the row
+
+    EECON1bits.FREE = 0;
+    bl_unlock();
+    EECON1bits.EEPGD = 0;
+}
+
+unsigned int bl_crc(unsigned int size) {
+    unsigned int crc = 0xFFFF;
+    unsigned char bit;
+
+    bl_tblptr(BL_APP_START);
+    while (size--) {
+        asm("TBLRD*+");
+        crc ^= (unsigned int)TABLAT << 8;
+        for (bit=0; bit<8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ BL_CRC_POLY : crc << 1;
+        }
+    }
+    return crc;
+}
+
+////                            Radio                                       ////
+
+//Each board listens on its own id, so an update only ever reaches one
+unsigned char bl_id(void) {
+    unsigned char id = bl_eeRead(BL_EE_ID);
+
+    if (id == 0xFF) return BL_ID;
+    return id;
+}
+
+void bl_radioInit(void) {
+    unsigned char addr[NRFS_ADDR_WIDTH] = NRFS_ADDR;
+    unsigned char i;
+
+    SPI_STATUS = 0b00000000;
+    SPI_CLK_EDGE = 1;
+    SPI_CONFIG_1 = SPI_CONFIG_1_VALUE;
+    SPI_CLK_POL = 0;
+    SPI_ENABLE = SET;
+    CE = CLEAR;
+    CSN = SET;
+
+    //Done here on a cold start, so the application's nrf_boot() skips it
+    if (!RCONbits.POR) {
+        bl_wait(BL_OVERFLOWS(NRF_TPOR_MS));
+        RCONbits.POR = 1;
+    }
+
+    for (i=0; i<sizeof(bl_radioTable); i+=2) {
+        nrf_SPI_RW_Reg(WRITE_REG + bl_radioTable[i], bl_radioTable[i+1]);
+    }
+    if (nrf_SPI_Read(FEATURE) != 0x06) {
+        nrf_SPI_RW_Reg(ACTIVATE, 0x73);
+        nrf_SPI_RW_Reg(WRITE_REG + FEATURE, 0x06);
+        nrf_SPI_RW_Reg(WRITE_REG + DYNPD, 0x01);
+    }
+    nrf_SPI_RW_Reg(FLUSH_TX, 0);
+    nrf_SPI_RW_Reg(FLUSH_RX, 0);
+
+    addr[0] = bl_id();
+    nrf_SPI_Write_Buf(WRITE_REG + RX_ADDR_P0, addr, NRFS_ADDR_WIDTH);
+
+    nrf_SPI_RW_Reg(WRITE_REG + CONFIG, NRF_CONFIG_RX);
+    bl_wait(BL_OVERFLOWS(2));
+    CE = SET;
+}
+
+void bl_radioOff(void) {
+    CE = CLEAR;
+    nrf_SPI_RW_Reg(WRITE_REG + CONFIG, 0x0C);
+    nrf_SPI_RW_Reg(FLUSH_TX, 0);
+    nrf_SPI_RW_Reg(FLUSH_RX, 0);
+}
+
+//Tops the TX FIFO up with ACK payloads carrying the current progress. It is
+//kept full so the packets that come in while a row is written still find
+//one; those report progress a few packets old, which is fine while the
+//offset only grows. fresh empties it first, for the answers to commands.
+void bl_ack(unsigned char fresh) {
+    unsigned char ack[BL_ACK_LEN];
+
+    ack[0] = BL_ACK;
+    ack[1] = bl_next >> 8;
+    ack[2] = bl_next & 0xFF;
+    ack[3] = bl_state;
+
+    if (fresh) nrf_SPI_RW_Reg(FLUSH_TX, 0);
+    while (!(nrf_SPI_Read(FIFO_STATUS) & TX_FULL)) {
+        nrf_SPI_Write_Buf(W_ACK_PAYLOAD | 0, ack, sizeof(ack));
+    }
+}
+
+unsigned char bl_receive(void) {
+    unsigned char len;
+
+    if (nrf_SPI_Read(FIFO_STATUS) & RX_EMPTY) return 0;
+
+    len = nrf_SPI_Read(R_RX_PL_WID);
+    if (len == 0 || len > MAX_PAYLOAD) {
+        nrf_SPI_RW_Reg(FLUSH_RX, 0);
+        len = 0;
+    } else {
+        nrf_SPI_Read_Buf(RD_RX_PLOAD, bl_buf, len);
+    }
+    nrf_SPI_RW_Reg(WRITE_REG + STATUS, RX_DR);
+    return len;
+}
+
+////                            Update                                      ////
+
+void bl_data(unsigned char len) {
+    unsigned int offset = (unsigned int)bl_buf[0] << 8 | bl_buf[1];
+    unsigned char i;
+
+    //duplicates and anything past a gap; the ACK tells the updater where to go on
+    if (bl_state != BL_RECEIVING || offset != bl_next) return;
+
+    if (bl_next + (len - 2) > BL_APP_END - BL_APP_START) {
+        bl_state = BL_BAD_IMAGE;
+        return;
+    }
+
+    for (i=2; i<len; i++) {
+        bl_row[bl_next & (BL_ROW - 1)] = bl_buf[i];
+        if ((++bl_next & (BL_ROW - 1)) == 0) {
+            bl_ack(0);
+            bl_writeRow(BL_APP_START + bl_next - BL_ROW);
+        }
+    }
+}
+
+//Writes out the partial last row and checks the whole image
+void bl_end(unsigned char len) {
+    unsigned int size = (unsigned int)bl_buf[1] << 8 | bl_buf[2];
+    unsigned int crc = (unsigned int)bl_buf[3] << 8 | bl_buf[4];
+    unsigned char i;
+
+    if (len < 5 || bl_state != BL_RECEIVING) return;
+
+    if (size > bl_next) {
+        bl_state = BL_BAD_IMAGE;
+        return;
+    }
+
+    i = bl_next & (BL_ROW - 1);
+    if (i) {
+        for (; i<BL_ROW; i++) {
+            bl_row[i] = 0xFF;
+        }
+        bl_writeRow(BL_APP_START + (bl_next & ~(BL_ROW - 1)));
+    }
+
+    if (bl_crc(size) == crc) {
+        bl_eeWrite(BL_EE_VALID, BL_EE_OK);
+        bl_state = BL_VERIFIED;
+    } else {
+        bl_state = BL_BAD_IMAGE;
+    }
+}
+
+//Serves the updater until BL_MSG_RUN on a verified image. timeout (Timer0
+//overflows) only runs while nobody has sent BL_MSG_ENTER; 0 waits for good.
+void bl_run(unsigned int timeout) {
+    unsigned int idle = 0;
+    unsigned char len;
+
+    bl_state = BL_IDLE;
+    bl_next = 0;
+    bl_ack(1);
+    INTCONbits.TMR0IF = 0;
+
+    while (1) {
+        asm("CLRWDT");
+
+        if (INTCONbits.TMR0IF) {
+            INTCONbits.TMR0IF = 0;
+            if (bl_state == BL_IDLE && timeout && ++idle >= timeout) return;
+        }
+
+        if ((len = bl_receive()) == 0) continue;
+
+        if (bl_buf[0] < 0x80) {
+            if (len > 2) bl_data(len);
+        } else if (bl_buf[0] == BL_MSG_ENTER) {
+            bl_next = 0;
+            bl_state = BL_RECEIVING;
+            bl_eeWrite(BL_EE_VALID, 0xFF);
+        } else if (bl_buf[0] == BL_MSG_END) {
+            bl_end(len);
+        } else if (bl_buf[0] == BL_MSG_RUN && bl_state == BL_VERIFIED) {
+            return;
+        }
+        //data keeps the FIFO going, the answer to a command has to be current
+        bl_ack(bl_buf[0] >= 0x80);
+    }
+}
+
+void main(void) {
+    unsigned int timeout = BL_OVERFLOWS(BL_LISTEN_MS);
+
+    bl_setup();
+
+    if (bl_eeRead(BL_EE_FLAGS) == BL_EE_REQUEST) {
+        bl_eeWrite(BL_EE_FLAGS, 0xFF);
+        timeout = BL_OVERFLOWS(BL_REQUEST_MS);
+    }
+    if (bl_eeRead(BL_EE_VALID) != BL_EE_OK) timeout = 0;
+
+    bl_radioInit();
+    bl_run(timeout);
+    bl_radioOff();
+
+    INTCONbits.TMR0IF = 0;
+    asm("goto 0x1000");     //BL_APP_START
+}
@@ -0,0 +1,60 @@
+// Over the air updater in the 2K word boot block (config.h: BBSIZ = BB2K).
+// The application is linked at BL_APP_START and the boot block forwards the
+// reset and interrupt vectors to it. bootloader.c is built on its own (the
+// "bootloader" configuration) and talks to the radio by polling.
+//
+// After a reset the bootloader listens on the board's id (BL_EE_ID, or BL_ID
+// on a board that has none) for BL_LISTEN_MS, then starts
+// the application if the last update verified. It stays once BL_MSG_ENTER
+// arrives and while no verified image is present. When the application set
+// BL_EE_REQUEST (lstore_bootRequest()) it waits BL_REQUEST_MS instead.
+//
+// The updater sends the image back to back as data payloads
+//
+//   offset hi, offset lo, BL_DATA image bytes
+//
+// and every ACK payload carries the offset the bootloader expects next, so
+// one ACK covers everything before it. Payloads that don't start at that
+// offset are dropped and the updater goes back to it (go-back-N). Offsets
+// stay below 0x8000, so a first byte with the top bit set is a command.
+//
+// The TX FIFO is kept full of ACK payloads, so the sender (serialrelay) can
+// have three payloads in flight and the packets that arrive during a row
+// write are still answered. An ACK payload can therefore be up to three
+// packets old; the highest offset seen is the current one. After a command
+// the FIFO is refilled, so the ACK to the next packet is current.
+
+#define BL_APP_START    0x1000
+#define BL_APP_END      0x8000
+#define BL_ROW          64      // flash erase/write block
+#define BL_DATA         30      // image bytes per data payload
+
+#define BL_ID           0x3B    // radio id in the bootloader if BL_EE_ID is unset
+#define BL_LISTEN_MS    50      // a few updater round trips
+#define BL_REQUEST_MS   10000   // wait for an updater after a request
+
+//Commands (first payload byte)
+#define BL_MSG_ENTER    0x80    // restart the transfer at offset 0
+#define BL_MSG_END      0x81    // size hi, size lo, crc hi, crc lo: verify
+#define BL_MSG_RUN      0x82    // start the application if it verified
+#define BL_MSG_STATUS   0x83    // no-op, fetches a fresh ACK payload
+#define BL_MSG_REQUEST  0xB0    // 'B', 'L', board id: to the application, reset into the bootloader
+
+//ACK payload: BL_ACK, next hi, next lo, state
+#define BL_ACK          0xB1
+#define BL_ACK_LEN      4
+#define BL_RECEIVING    0x00
+#define BL_VERIFIED     0x01
+#define BL_BAD_IMAGE    0x02
+#define BL_IDLE         0x03    // waiting for BL_MSG_ENTER
+
+//Data EEPROM, above the link store. BL_EE_ID is set once per board when it
+//is programmed (0xFF, erased, means BL_ID).
+#define BL_EE_ID        0x3FD   // board id: the bootloader's radio id
+#define BL_EE_VALID     0x3FE   // BL_EE_OK once an image verified
+#define BL_EE_OK        0xA5
+#define BL_EE_FLAGS     0x3FF
+#define BL_EE_REQUEST   0xB0
+
+//CRC-16/CCITT (init 0xFFFF) over the image bytes
+#define BL_CRC_POLY     0x1021
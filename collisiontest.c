@@ -5,6 +5,14 @@
 #include "config.h"
 #include "serlcd.h"
 #include "nRF2401.h"
+#include "telemetry.h"
+#include "nrf_shadow.h"
+#include "nrf_boot.h"
+#include "sched.h"
+#include "sniffer.h"
+#include "net.h"
+#include "join.h"
+#include "linkstore.h"
 
 #define LED_GREEN_TRIS TRISBbits.TRISB4
 #define LED_GREEN PORTBbits.RB4
@@ -31,6 +39,18 @@
 #define DIP_3_TRIS TRISBbits.TRISB1
 #define DIP_3 PORTBbits.RB1
 
+#define RELAY_SELECT_TRIS TRISBbits.TRISB2
+#define RELAY_SELECT PORTBbits.RB2
+#define MODE_RELAY 0
+
+#define ROLE_MASTER 0
+#define ROLE_SLAVE 1
+#define ROLE_RELAY 2
+
+//Latched in setup(): RB0 doubles as the radio's CSN, so the pin is not the
+//switch any more once the radio is running
+unsigned char role = ROLE_SLAVE;
+
 unsigned char tx_buf[MAX_PAYLOAD];
 unsigned char rx_buf[MAX_PAYLOAD];
 
@@ -44,8 +64,8 @@ void masterInterrupt(void);
 void slaveMain(void);
 void slaveInterrupt(void);
 
-////                            Shared Code                                 ////
-void delay(void);
+////                          RelayCode                                 ////
+void relayMain(void);
 
 ////                            System Code                                 ////
 void run(void);
@@ -63,11 +83,19 @@ void setup(void) {
     LED_RED_TRIS = OUTPUT;
     PROBE_TRIS = OUTPUT;
     DIP_3_TRIS = INPUT;
+    RELAY_SELECT_TRIS = INPUT;
 
     //Enable internal pullup resistor for port B
     INTCON2bits.RBPU = CLEAR;
     WPUB = 0b1111;
 
+    //before CSN takes the pin over
+    if (RELAY_SELECT == MODE_RELAY) {
+        role = ROLE_RELAY;
+    } else if (MODE_SELECT == MODE_SEND) {
+        role = ROLE_MASTER;
+    }
+
     //This is to toggle pins from digital to analog
     //unimp, RD3, RD2, RD1     RD1, AN10, AN9, AN8 (in order)
     ANCON0 = 0b00000000;
@@ -116,7 +144,7 @@ void setup(void) {
     BAUDCON1bits.BRG16 = 0;
     TXSTA1bits.BRGH = 1;
 
-    // 19.2kbaud = 001, 832
+    // 64MHz / (16 * (34 + 1)) = 114.3kbaud, 0.8% off the host side 115200
     SPBRG1 = 34;
     
     //9.6kbaud = 000, 103
@@ -128,43 +156,67 @@ void setup(void) {
 ////                            Sender Code                                 ////
 ////                                                                        ////
 ////////////////////////////////////////////////////////////////////////////////
-#define MAX_CLIENTS 10
-int clients[MAX_CLIENTS];
-int clientInfo[MAX_CLIENTS];
-void masterMain() {
-    //master
-    short i;
-    short l;
-    short nextSlot;
-    char status;
+#define RADIO_PERIOD    SCHED_MS(40)
+#define REPORT_PERIOD   SCHED_MS(1000)
+#define KEEPALIVE_PERIOD SCHED_MS(2000)
 
-    nrf_init();
-    delay();
+void reportTask(void) {
+    tlm_flushStatus();
+    sched_report();
+}
 
-    nrf_rxmode();
-    delay();
+unsigned int rxCount[8];    //payloads per pipe, live and replayed
+
+void reportMaster(void) {
+    tlm_sendCounters(rxCount, 6);
+    net_sendRoutes();
+    reportTask();
+}
+
+//Counts frames per pipe they arrived on; relayed frames all come in on the
+//relay's pipe, the route table says where they started
+void masterHandle(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    if (net_accept(buf, len) != NET_LOCAL) return;
+    if (join_handle(pipe, buf, len)) return;
+    rxCount[pipe & 0x07]++;
+}
+
+void masterTask(void) {
+    char status;
+    unsigned char pipe;
+    unsigned char len;
+    unsigned char result = 0;
+
+    LED_RED = !LED_RED;
+    status = nrf_getStatus();
+    while ((len = sniff_next(rx_buf, &pipe)) != 0) {
+        masterHandle(pipe, rx_buf, len);
+        result = 1;
+    }
+    LED_GREEN = result;
+    tlm_noteStatus(status, result);
+}
 
-    nrf_setTxAddr(0);
-    nrf_setRxAddr(0,0);
+void masterMain() {
+    //master
+    nrf_bootRx();
 
-    nrf_enablePipe(1);
-    nrf_setRxAddr(1,1);
+    net_init(NET_MASTER, NET_MASTER, 0);
+    join_masterInit();
  
     sendLiteralBytes("Master!\n");
 
-    while(1) {
-        LED_RED = !LED_RED;
-        status = nrf_getStatus();
-        sendLiteralBytes("Status: ");
-        sendBin(status);
-        sendLiteralBytes("\n");
-        LED_GREEN = nrf_receive(&tx_buf,&rx_buf);
-        delay();
-    }
+    sniff_init(0);
+
+    sched_init();
+    sched_addPeriodic(masterTask, 1);
+    sched_addPeriodic(join_rotate, JOIN_WINDOW);
+    sched_addPeriodic(reportMaster, REPORT_PERIOD);
+    sched_run();
 }
 
 void masterInterrupt(void) {
-
+    tlm_rxService();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -173,51 +225,168 @@ void masterInterrupt(void) {
 ////                                                                        ////
 ////////////////////////////////////////////////////////////////////////////////
 
-void slaveMain() {
-    //slave
-    int i;
-    char offset;
-    char status;
+unsigned char slaveTaskId = SCHED_NONE;
+unsigned char relayIdle = 1;
+unsigned char sendFails = 0;
+unsigned int slaveHunt = 0;     //ticks spent hunting for our rotation window
 
-    nrf_init();
-    delay();
+#define SEND_PLAIN      0       // failures count towards a rejoin
+#define SEND_FAILOVER   1       // ...and switch parent every NET_FAIL_LIMIT
+#define SEND_HUNT       2       // failures don't count
 
-    nrf_txmode();
-    delay();
+//Tries the relays in turn (and back again) when the parent stops acking, and
+//starts over with a join once the master has evidently dropped the slot
+unsigned char slaveSend(unsigned char mode) {
+    unsigned char result;
 
-    sendLiteralBytes("Slave!\n");
+    net_header(tx_buf, NET_MASTER);
+    tx_buf[NET_DATA] = NET_MSG_DATA;
+    result = net_send(tx_buf);
+
+    if (result) {
+        sendFails = 0;
+        join_heard(net_ack);
+        return result;
+    }
+    if (mode == SEND_HUNT) return result;
+
+    if (++sendFails >= JOIN_REJOIN) {
+        sendFails = 0;
+        join_start();
+    } else if (mode == SEND_FAILOVER && sendFails % NET_FAIL_LIMIT == 0) {
+        net_parent = join_nextParent(net_parent);
+    }
+    return result;
+}
 
-    if (DIP_3) {
-        sendLiteralBytes("DIP ON\n");
-        nrf_setTxAddr(0);
-        nrf_setRxAddr(0,0);
-        nrf_setRxAddr(1,1);
+void slaveTask(void) {
+    LED_RED = !LED_RED;
+
+    if (join_id == NET_NONE) {
+        LED_GREEN = join_poll(tx_buf, rx_buf, JOIN_ROLE_SLAVE) != NET_NONE;
+        slaveHunt = 1;
+        return;
+    }
+
+    //Keep to our rotation window once found, hunt for it tick by tick if not.
+    //Those misses are expected; only a whole cycle without a hit is a failure.
+    if (join_groups > 1 && slaveHunt && slaveHunt < join_groups * JOIN_WINDOW) {
+        LED_GREEN = slaveSend(SEND_HUNT);
     } else {
-        sendLiteralBytes("DIP OFF\n");
-        nrf_setTxAddr(1);
-        nrf_setRxAddr(0,1);
-        nrf_setRxAddr(1,0);
+        LED_GREEN = slaveSend(SEND_FAILOVER);
+        slaveHunt = 0;
     }
 
-    while(1) {
-        LED_RED = !LED_RED;
-        LED_GREEN = nrf_send(&tx_buf,&rx_buf);
-        delay();
+    if (LED_GREEN) {
+        slaveHunt = 0;
+        sched_delay(slaveTaskId, join_period(RADIO_PERIOD));
+    } else if (join_groups > 1) {
+        slaveHunt++;
+        sched_delay(slaveTaskId, 1);
     }
 }
 
+void slaveMain() {
+    //slave
+    nrf_bootTx();
+
+    sendLiteralBytes("Slave!\n");
+
+    //a warm boot asks for the slot from the last session again
+    join_start();
+    lstore_restore(JOIN_ROLE_SLAVE);
+
+    sched_init();
+    slaveTaskId = sched_addPeriodic(slaveTask, RADIO_PERIOD);
+    sched_addPeriodic(lstore_task, 1);
+    sched_addPeriodic(reportTask, REPORT_PERIOD);
+    sched_run();
+}
+
 void slaveInterrupt() {
 
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 ////                                                                        ////
-////                            Shared Code                                 ////
+////                            Relay Code                                  ////
 ////                                                                        ////
 ////////////////////////////////////////////////////////////////////////////////
 
-void delay(void) {
-    Delay10KTCYx(254);
+unsigned char relayAssign[5];
+unsigned char relayAssignLen = 0;
+
+//Answers to joins made through us come back in the ACK payload of a send.
+//They are our ACK payload on the relay address for the node that asked, and
+//every send flushes TX, so they go back in after each one until that node
+//shows up under its new id.
+void relayAnswer(unsigned char result) {
+    unsigned char i;
+
+    if (result && net_ack[0] == NET_MSG_ASSIGN) {
+        for (i=0; i<sizeof(relayAssign); i++) {
+            relayAssign[i] = net_ack[i];
+        }
+        relayAssignLen = sizeof(relayAssign);
+    }
+    if (relayAssignLen) sniff_ack(1, relayAssign, relayAssignLen);
+}
+
+void relayTask(void) {
+    unsigned char pipe;
+    unsigned char len;
+
+    if (join_id == NET_NONE) return;
+
+    LED_RED = !LED_RED;
+    while ((len = sniff_next(rx_buf, &pipe)) != 0) {
+        if (relayAssignLen && len > NET_SRC && rx_buf[NET_SRC] == relayAssign[3]) relayAssignLen = 0;
+        if (net_accept(rx_buf, len) == NET_FORWARD) {
+            LED_GREEN = net_forward(rx_buf);
+            if (LED_GREEN) join_heard(net_ack);
+            relayAnswer(LED_GREEN);
+        }
+    }
+}
+
+//Joins like a slave, then keeps the slot alive when nobody sends through us
+void relayLink(void) {
+    unsigned char result;
+
+    if (join_id == NET_NONE) {
+        if (join_poll(tx_buf, rx_buf, JOIN_ROLE_RELAY) == NET_NONE) return;
+        net_init(join_id, join_parent(), 1);
+        nrfs_rxmode();
+        return;
+    }
+
+    if (--relayIdle != 0) return;
+    relayIdle = KEEPALIVE_PERIOD / RADIO_PERIOD;
+
+    result = slaveSend(SEND_PLAIN);
+    if (!result && join_id == NET_NONE) {
+        net_relaying = 0;
+        nrfs_txmode();
+        return;
+    }
+    relayAnswer(result);
+}
+
+void relayMain() {
+    nrf_bootTx();
+
+    sendLiteralBytes("Relay!\n");
+
+    join_start();
+    lstore_restore(JOIN_ROLE_RELAY);
+    sniff_init(0);
+
+    sched_init();
+    sched_addPeriodic(relayTask, 1);
+    sched_addPeriodic(relayLink, RADIO_PERIOD);
+    sched_addPeriodic(lstore_task, 1);
+    sched_addPeriodic(reportTask, REPORT_PERIOD);
+    sched_run();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -228,7 +397,9 @@ void delay(void) {
 
 void run(void) {
     while(1) {
-        if (MODE_SELECT == MODE_SEND) {
+        if (role == ROLE_RELAY) {
+            relayMain();
+        } else if (role == ROLE_MASTER) {
             masterMain();
         } else {
             slaveMain();
@@ -245,7 +416,9 @@ void main(void) {
 }
 
 void interrupt interrupt_high(void) {
-    if (MODE_SELECT == MODE_SEND) {
+    if (INTCONbits.TMR0IF) sched_tick();
+
+    if (role != ROLE_SLAVE) {
         masterInterrupt();
     } else {
         slaveInterrupt();
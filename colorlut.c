@@ -0,0 +1,312 @@
+// Generated by tools/mklut -g 2.50 -m 15, do not edit.
+
+#include "strip.h"
+
+const unsigned char strip_lut[STRIP_LUT_ROWS][256] @ STRIP_LUT_ADDR = {
+    { // level 0
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+          0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+    },
+    { // level 1
+          0,  0,  0,  0,  1,  1,  2,  3,  4,  5,  6,  8, 10, 12, 14, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+         17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17
+    },
+    { // level 2
+          0,  0,  0,  1,  1,  2,  3,  5,  7,  9, 12, 16, 19, 24, 29, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34,
+         34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34
+    },
+    { // level 3
+          0,  0,  0,  1,  2,  3,  5,  8, 11, 14, 19, 23, 29, 36, 43, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51,
+         51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51, 51
+    },
+    { // level 4
+          0,  0,  0,  1,  2,  4,  7, 10, 14, 19, 25, 31, 39, 48, 57, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68,
+         68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68
+    },
+    { // level 5
+          0,  0,  1,  2,  3,  5,  9, 13, 18, 24, 31, 39, 49, 59, 72, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85,
+         85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85, 85
+    },
+    { // level 6
+          0,  0,  1,  2,  4,  7, 10, 15, 21, 28, 37, 47, 58, 71, 86,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+        102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102
+    },
+    { // level 7
+          0,  0,  1,  2,  4,  8, 12, 18, 25, 33, 43, 55, 68, 83,100,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,
+        119,119,119,119,119,119,119,119,119,119,119,119,119,119,119,119
+    },
+    { // level 8
+          0,  0,  1,  2,  5,  9, 14, 20, 28, 38, 49, 63, 78, 95,114,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,
+        136,136,136,136,136,136,136,136,136,136,136,136,136,136,136,136
+    },
+    { // level 9
+          0,  0,  1,  3,  6, 10, 15, 23, 32, 43, 56, 70, 88,107,129,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+        153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153
+    },
+    { // level 10
+          0,  0,  1,  3,  6, 11, 17, 25, 35, 47, 62, 78, 97,119,143,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+        170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170
+    },
+    { // level 11
+          0,  0,  1,  3,  7, 12, 19, 28, 39, 52, 68, 86,107,131,157,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,
+        187,187,187,187,187,187,187,187,187,187,187,187,187,187,187,187
+    },
+    { // level 12
+          0,  0,  1,  4,  7, 13, 21, 30, 42, 57, 74, 94,117,143,172,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+        204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204
+    },
+    { // level 13
+          0,  0,  1,  4,  8, 14, 22, 33, 46, 62, 80,102,127,155,186,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,
+        221,221,221,221,221,221,221,221,221,221,221,221,221,221,221,221
+    },
+    { // level 14
+          0,  0,  2,  4,  9, 15, 24, 35, 49, 66, 86,110,136,166,200,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,
+        238,238,238,238,238,238,238,238,238,238,238,238,238,238,238,238
+    },
+    { // level 15
+          0,  0,  2,  5,  9, 16, 26, 38, 53, 71, 93,117,146,178,215,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+        255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255
+    },
+    { // raw 16
+          0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+         16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+         32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+         48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+         64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+         80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+         96, 97, 98, 99,100,101,102,103,104,105,106,107,108,109,110,111,
+        112,113,114,115,116,117,118,119,120,121,122,123,124,125,126,127,
+        128,129,130,131,132,133,134,135,136,137,138,139,140,141,142,143,
+        144,145,146,147,148,149,150,151,152,153,154,155,156,157,158,159,
+        160,161,162,163,164,165,166,167,168,169,170,171,172,173,174,175,
+        176,177,178,179,180,181,182,183,184,185,186,187,188,189,190,191,
+        192,193,194,195,196,197,198,199,200,201,202,203,204,205,206,207,
+        208,209,210,211,212,213,214,215,216,217,218,219,220,221,222,223,
+        224,225,226,227,228,229,230,231,232,233,234,235,236,237,238,239,
+        240,241,242,243,244,245,246,247,248,249,250,251,252,253,254,255
+    }
+};
@@ -0,0 +1,69 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "eeprom.h"
+
+void ee_init(void) {
+    EE_CS_TRIS = OUTPUT;
+    EE_CS = 1;
+}
+
+unsigned char ee_xfer(unsigned char byte) {
+    SPI_BUFFER = byte;
+    while (!SPI_BUFFER_FULL_STAT);
+    return SPI_BUFFER;
+}
+
+void ee_command(unsigned char cmd, unsigned int addr) {
+    EE_CS = 0;
+    ee_xfer(cmd);
+    ee_xfer(addr >> 8);
+    ee_xfer(addr & 0xFF);
+}
+
+unsigned char ee_busy(void) {
+    unsigned char status;
+
+    EE_CS = 0;
+    ee_xfer(EE_RDSR);
+    status = ee_xfer(0);
+    EE_CS = 1;
+    return status & EE_WIP;
+}
+
+//Sequential read, any length, across page boundaries
+void ee_read(unsigned int addr, unsigned char * buf, unsigned char len) {
+    ee_command(EE_READ, addr);
+    while (len--) {
+        *buf++ = ee_xfer(0);
+    }
+    EE_CS = 1;
+}
+
+unsigned char ee_readByte(unsigned int addr) {
+    unsigned char value;
+
+    ee_read(addr, &value, 1);
+    return value;
+}
+
+//Starts a write of up to the end of addr's page. Returns the number of bytes
+//taken (0 while a write cycle is still running).
+unsigned char ee_write(unsigned int addr, unsigned char * buf, unsigned char len) {
+    unsigned char room = EE_PAGE - (addr & (EE_PAGE - 1));
+    unsigned char i;
+
+    if (ee_busy()) return 0;
+    if (len > room) len = room;
+
+    EE_CS = 0;
+    ee_xfer(EE_WREN);
+    EE_CS = 1;
+
+    ee_command(EE_WRITE, addr);
+    for (i=0; i<len; i++) {
+        ee_xfer(buf[i]);
+    }
+    EE_CS = 1;
+    return len;
+}
@@ -0,0 +1,23 @@
+// 25LC256 style SPI EEPROM on the radio's MSSP, selected by RB3. Both parts
+// run SPI mode 0, so sharing the bus needs no reconfiguration; callers just
+// never touch either part from an interrupt. Writes only start the internal
+// write cycle (up to 5ms) and return; poll ee_busy() from a task instead of
+// waiting on it.
+
+#define EE_CS_TRIS      TRISBbits.TRISB3
+#define EE_CS           PORTBbits.RB3
+
+#define EE_SIZE         32768
+#define EE_PAGE         64
+
+#define EE_READ         0x03
+#define EE_WRITE        0x02
+#define EE_WREN         0x06
+#define EE_RDSR         0x05
+#define EE_WIP          0x01
+
+void ee_init(void);
+unsigned char ee_busy(void);
+void ee_read(unsigned int addr, unsigned char * buf, unsigned char len);
+unsigned char ee_readByte(unsigned int addr);
+unsigned char ee_write(unsigned int addr, unsigned char * buf, unsigned char len);
@@ -0,0 +1,268 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "sched.h"
+#include "sniffer.h"
+#include "net.h"
+#include "join.h"
+
+//Slot table: nonce of the owner (0 = free) and the tick it was last heard
+int clients[MAX_CLIENTS];
+int clientInfo[MAX_CLIENTS];
+
+unsigned char join_group = 0;
+unsigned char join_groups = 1;
+
+unsigned char join_id = NET_NONE;
+unsigned char join_via = NET_DISCOVERY;
+unsigned int join_nonce = 0;
+unsigned char join_frozen = 0;
+unsigned char join_fails = 0;
+
+unsigned int join_now(void) {
+    unsigned int now;
+
+    do {
+        now = sched_ticks;
+    } while (now != sched_ticks);
+    return now;
+}
+
+////                                Master                                  ////
+
+//Also the default ACK payload, so clients that joined earlier keep up
+void join_ackGroups(void) {
+    sniff_ackData[0] = NET_MSG_GROUPS;
+    sniff_ackData[1] = join_groups;
+    sniff_ackLen = 2;
+}
+
+void join_countGroups(void) {
+    unsigned char i;
+
+    join_groups = 1;
+    for (i=1; i<MAX_CLIENTS; i++) {
+        if (clients[i] != 0) join_groups = (i - 1) / JOIN_PIPES + 1;
+    }
+    join_ackGroups();
+}
+
+void join_masterInit(void) {
+    unsigned char i;
+
+    for (i=0; i<MAX_CLIENTS; i++) {
+        clients[i] = 0;
+    }
+    join_group = 0;
+    join_countGroups();
+
+    nrfs_setRxAddr(0, NET_DISCOVERY);
+    nrfs_enablePipe(1);
+    nrfs_setRxAddr(1, NET_SLAVE);
+    for (i=2; i<2+JOIN_PIPES; i++) {
+        nrfs_enablePipe(i);
+    }
+    //only pipes with an owner in the current group stay on
+    join_rotate();
+}
+
+void join_seen(unsigned char id) {
+    unsigned char slot = id - NET_SLAVE;
+
+    if (slot < MAX_CLIENTS && clients[slot] != 0) clientInfo[slot] = join_now();
+}
+
+//A relay gets slot 0 (never rotated out) if it is free
+unsigned char join_slot(unsigned int nonce, unsigned char role) {
+    unsigned char i;
+    unsigned char free = NET_NONE;
+
+    for (i=0; i<MAX_CLIENTS; i++) {
+        if (clients[i] == (int)nonce) return i;
+    }
+
+    if (role == JOIN_ROLE_RELAY && clients[0] == 0) {
+        free = 0;
+    } else {
+        for (i=MAX_CLIENTS-1; i>0; i--) {
+            if (clients[i] == 0) free = i;
+        }
+    }
+    if (free == NET_NONE) return NET_NONE;
+
+    clients[free] = nonce;
+    join_countGroups();
+    if (free == 0) nrfs_setBits(EN_RXADDR, 1 << 1);
+    return free;
+}
+
+//The answer goes out with the next ACK on the pipe the request came in on
+//(the discovery pipe, or a relay's slot)
+void join_answer(unsigned char pipe, unsigned int nonce, unsigned char slot) {
+    unsigned char reply[5];
+
+    reply[0] = NET_MSG_ASSIGN;
+    reply[1] = nonce & 0xFF;
+    reply[2] = nonce >> 8;
+    reply[3] = NET_SLAVE + slot;
+    reply[4] = join_groups;
+
+    sniff_ack(pipe, reply, sizeof(reply));
+}
+
+//Takes every NET_LOCAL frame; returns 1 if it was a join request
+unsigned char join_handle(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    unsigned int nonce;
+    unsigned char slot;
+
+    //a relayed frame also proves the relay is alive
+    join_seen(buf[NET_SRC]);
+    join_seen(buf[NET_LAST]);
+
+    if (len < NET_DATA + 4 || buf[NET_DATA] != NET_MSG_JOIN) return 0;
+
+    nonce = buf[NET_DATA+1] | (buf[NET_DATA+2] << 8);
+    if (nonce == 0) return 1;   //entropy probe
+
+    slot = join_slot(nonce, buf[NET_DATA+3]);
+    if (slot == NET_NONE) return 1;
+
+    clientInfo[slot] = join_now();
+    join_answer(pipe & 0x07, nonce, slot);
+    return 1;
+}
+
+//Every JOIN_WINDOW: expire idle slots and map the next group onto pipes 2-5.
+//Those pipes only hold the address LSByte, so a rotation is four 1 byte writes.
+//A pipe whose slot has no owner is switched off, so a node that still sends
+//to a freed address gets no ACK and knows to rejoin.
+void join_rotate(void) {
+    unsigned char i;
+    unsigned char slot;
+    unsigned char enabled;
+    unsigned int now = join_now();
+
+    for (i=0; i<MAX_CLIENTS; i++) {
+        if (clients[i] != 0 && now - (unsigned int)clientInfo[i] > JOIN_EXPIRE) {
+            clients[i] = 0;
+            join_countGroups();
+        }
+    }
+
+    if (++join_group >= join_groups) join_group = 0;
+
+    enabled = nrfs_read(EN_RXADDR) & 0x03;
+    if (clients[0] == 0) enabled &= ~(1 << 1);
+
+    for (i=0; i<JOIN_PIPES; i++) {
+        slot = 1 + join_group * JOIN_PIPES + i;
+        if (slot < MAX_CLIENTS && clients[slot] != 0) {
+            nrfs_setRxAddr(i + 2, NET_SLAVE + slot);
+            enabled |= 1 << (i + 2);
+        }
+    }
+    nrfs_write(EN_RXADDR, enabled);
+}
+
+////                                Client                                  ////
+
+void join_start(void) {
+    join_id = NET_NONE;
+    join_frozen = 0;
+    join_fails = 0;
+}
+
+//The send completes on the radio's crystal, Timer0 runs from the internal
+//oscillator, so the low bits of TMR0 at that point differ from board to board
+void join_stir(void) {
+    join_nonce = (join_nonce << 3) ^ (join_nonce >> 13) ^ TMR0L;
+}
+
+//One join attempt, tx and rx as for nrf_send(). Returns the assigned id, or
+//NET_NONE while still waiting.
+unsigned char join_poll(unsigned char * tx, unsigned char * rx, unsigned char role) {
+    unsigned char result;
+    unsigned char via;
+
+    //Until one request with our nonce got through, the send is just a probe
+    //and the nonce keeps changing
+    net_self = 0x80 | (join_nonce & 0x7F);
+    net_header(tx, NET_MASTER);
+    tx[NET_DATA] = NET_MSG_JOIN;
+    tx[NET_DATA+1] = join_frozen ? join_nonce & 0xFF : 0;
+    tx[NET_DATA+2] = join_frozen ? join_nonce >> 8 : 0;
+    tx[NET_DATA+3] = role;
+
+    //then one try at each relay address in turn
+    via = NET_DISCOVERY;
+    if (join_fails >= JOIN_VIA_RELAY) via = NET_RELAY + join_fails - JOIN_VIA_RELAY;
+    nrfs_setTxAddr(via);
+
+    result = nrf_send(tx, rx);
+
+    if (!join_frozen) {
+        join_stir();
+        if (result && join_nonce != 0) join_frozen = 1;
+    }
+
+    if (!result) {
+        if (++join_fails >= JOIN_VIA_RELAY + MAX_CLIENTS) join_fails = 0;
+        return NET_NONE;
+    }
+
+    //nrf_send() left the ACK payload in rx
+    if (rx[0] == NET_MSG_ASSIGN && rx[1] == (join_nonce & 0xFF) && rx[2] == (join_nonce >> 8)) {
+        join_id = rx[3];
+        join_groups = rx[4];
+        join_via = via;
+        join_fails = 0;
+        net_init(join_id, join_parent(), 0);
+    }
+    return join_id;
+}
+
+//Frames for the master go to our slot address there, or to the relay that
+//passed our join on (which may itself sit behind another relay)
+unsigned char join_parent(void) {
+    if (join_via == NET_DISCOVERY) return join_id;
+    return join_via;
+}
+
+//Where a client tries next once its parent stops acking: its slot address,
+//then each relay address in turn
+unsigned char join_nextParent(unsigned char parent) {
+    if (parent == join_id) return NET_RELAY;
+    if (++parent >= NET_RELAY + MAX_CLIENTS) return join_id;
+    return parent;
+}
+
+//Carries the nonce over from an earlier session (see linkstore.h). The next
+//join_poll() asks for a slot with it right away, the way the last join went,
+//and the master answers with the slot it still holds for that nonce (or a
+//new one if it has dropped it); the id is only taken up from that answer.
+void join_resume(unsigned char via, unsigned int nonce) {
+    join_start();
+    if (nonce == 0) return;
+
+    join_nonce = nonce;
+    join_frozen = 1;
+    if (via >= NET_RELAY && via < NET_RELAY + MAX_CLIENTS) join_fails = JOIN_VIA_RELAY + via - NET_RELAY;
+}
+
+//Takes the ACK payload of every successful send from a joined client
+void join_heard(unsigned char * ack) {
+    if (ack[0] != NET_MSG_GROUPS || ack[1] == 0) return;
+
+    join_groups = ack[1];
+    if (net_relaying) join_ackGroups();
+}
+
+//Stretches a send period to whole rotation cycles so a client that hit its
+//window once keeps hitting it
+unsigned int join_period(unsigned int period) {
+    unsigned int cycle = join_groups * JOIN_WINDOW;
+
+    if (join_groups <= 1) return period;
+    return ((period + cycle - 1) / cycle) * cycle;
+}
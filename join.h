@@ -0,0 +1,54 @@
+// Join handshake and address assignment. Unassigned nodes send NET_MSG_JOIN
+// to the discovery address; the master answers with NET_MSG_ASSIGN in the
+// ACK payload of that pipe, giving the client a slot in clients[] and the
+// matching id/address. Pipe 0 stays on the discovery address and pipe 1 on
+// slot 0, which is kept for a relay. Slots 1-9 share pipes 2-5: slot s
+// listens on pipe 2 + (s-1)%4 during window group (s-1)/4, and the master
+// rotates those pipes' address bytes through the groups every JOIN_WINDOW.
+// Slots not heard from for JOIN_EXPIRE are freed. The group count changes as
+// clients come and go, so every other ACK payload from the master carries it
+// (NET_MSG_GROUPS), and relays pass it on in theirs.
+
+#define NET_DISCOVERY   0x30    // well known join address
+
+//First data byte after the net header
+#define NET_MSG_DATA    0x00
+#define NET_MSG_JOIN    0x01    // nonce lo, nonce hi, role
+#define NET_MSG_ASSIGN  0x02    // nonce lo, nonce hi, id, groups (ACK payload, no net header)
+#define NET_MSG_GROUPS  0x03    // groups (default ACK payload, no net header)
+
+#define MAX_CLIENTS     10
+#define JOIN_PIPES      4       // pipes 2-5 rotate, pipe 1 is fixed on slot 0
+
+#define JOIN_ROLE_SLAVE 0
+#define JOIN_ROLE_RELAY 1
+#define JOIN_WINDOW     SCHED_MS(12)
+#define JOIN_EXPIRE     SCHED_MS(10000)
+#define JOIN_REJOIN     16      // failed sends in a row before a client rejoins
+#define JOIN_VIA_RELAY  4       // failed joins before asking through the relays
+
+#ifndef TX_FULL
+#define TX_FULL         0x20    // FIFO_STATUS
+#endif
+
+extern int clients[MAX_CLIENTS];
+extern int clientInfo[MAX_CLIENTS];
+
+extern unsigned char join_id;
+extern unsigned char join_via;
+extern unsigned char join_groups;
+extern unsigned int join_nonce;
+
+//Master
+void join_masterInit(void);
+unsigned char join_handle(unsigned char pipe, unsigned char * buf, unsigned char len);
+void join_rotate(void);
+
+//Client
+void join_start(void);
+unsigned char join_poll(unsigned char * tx, unsigned char * rx, unsigned char role);
+unsigned char join_parent(void);
+unsigned char join_nextParent(unsigned char parent);
+void join_resume(unsigned char via, unsigned int nonce);
+void join_heard(unsigned char * ack);
+unsigned int join_period(unsigned int period);
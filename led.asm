@@ -3,6 +3,97 @@
     GLOBAL _populateLeds        ; make _add globally accessible
     SIGNAT _populateLeds,4217   ; tell the linker how it should be called
 
+    GLOBAL _strip_sendWindow
+    SIGNAT _strip_sendWindow,4217
+    GLOBAL _strip_ptr, _strip_count, _strip_lutRow
+
+; Scratch for strip_sendWindow, in access RAM so the bit loop needs no BSR.
+; The linker places it alongside the compiler's own COMRAM variables.
+    PSECT ledvars,class=COMRAM,space=1
+ledSave:    DS 2                    ; caller's FSR1
+ledLeft:    DS 1                    ; LEDs left
+ledComps:   DS 1                    ; components left
+ledBits:    DS 1                    ; bits left
+ledShift:   DS 1                    ; shift register
+
+    PSECT ledtext,class=CODE,reloc=2
+
 _populateLeds:
 
-    RETURN
\ No newline at end of file
+    RETURN
+
+; Clocks strip_count LEDs (3 bytes each, GRB) from strip_ptr out on RA0.
+; Same bit timing as the old updateLEDs: one bit per Timer2 period (PR2 = 20,
+; 21 cycles = 1.3us), about 250ns high for a zero and 600ns for a one. The caller keeps
+; GIE off and sets TMR2IF for the first window of a frame; later windows wait
+; for the flag, so the bit rate is kept across the gap.
+;
+; Every byte goes through the colour table row in strip_lutRow for its
+; channel (FSR1 walks the rows). The lookup costs 6 cycles of low time at
+; each byte boundary, which the strip tolerates.
+_strip_sendWindow:
+    MOVFF FSR1L, ledSave
+    MOVFF FSR1H, ledSave+1
+    CLRF TBLPTRU, ACCESS
+
+    MOVFF _strip_ptr, FSR0L
+    MOVFF _strip_ptr+1, FSR0H
+    MOVFF _strip_count, ledLeft
+    LFSR 1, _strip_lutRow
+
+    MOVF POSTINC0, W, ACCESS
+    MOVWF TBLPTRL, ACCESS
+    MOVFF POSTINC1, TBLPTRH
+    TBLRD*
+    MOVFF TABLAT, ledShift
+    MOVLW 3
+    MOVWF ledComps, ACCESS
+    MOVLW 8
+    MOVWF ledBits, ACCESS
+
+bitWait:
+    BTFSS PIR1, 1, ACCESS
+    BRA bitWait
+
+    BSF LATA, 0, ACCESS             ; SET
+    BCF PIR1, 1, ACCESS
+
+    RLCF ledShift, F, ACCESS
+    BC sendOne
+
+    BCF LATA, 0, ACCESS             ; CLEAR (zero)
+    BRA bitDone
+
+sendOne:
+    NOP
+    NOP
+    NOP
+    NOP
+    NOP
+    BCF LATA, 0, ACCESS             ; CLEAR (one)
+
+bitDone:
+    DECF ledBits, F, ACCESS
+    BNZ bitWait
+
+    MOVF POSTINC0, W, ACCESS
+    MOVWF TBLPTRL, ACCESS
+    MOVFF POSTINC1, TBLPTRH
+    TBLRD*
+    MOVFF TABLAT, ledShift
+    MOVLW 8
+    MOVWF ledBits, ACCESS
+
+    DECF ledComps, F, ACCESS
+    BNZ bitWait
+
+    MOVLW 3
+    MOVWF ledComps, ACCESS
+    LFSR 1, _strip_lutRow+1         ; G was already fetched from row 3
+
+    DECF ledLeft, F, ACCESS
+    BNZ bitWait
+
+    MOVFF ledSave, FSR1L
+    MOVFF ledSave+1, FSR1H
+    RETURN
@@ -0,0 +1,156 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "telemetry.h"
+#include "net.h"
+#include "join.h"
+#include "bootloader.h"
+#include "linkstore.h"
+
+unsigned char lstore_saved[LSTORE_RECORD];  // newest record in the EEPROM
+unsigned char lstore_slot = LSTORE_SLOTS - 1;
+unsigned char lstore_role = 0;
+
+unsigned char lstore_pending[LSTORE_RECORD];
+unsigned char lstore_written = LSTORE_RECORD;   // bytes of lstore_pending done
+
+unsigned char lstore_readByte(unsigned int addr) {
+    EEADRH = addr >> 8;
+    EEADR = addr & 0xFF;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.CFGS = 0;
+    EECON1bits.RD = 1;
+    return EEDATA;
+}
+
+//Starts a byte write (about 4ms, the old value is erased by the part itself)
+void lstore_writeByte(unsigned int addr, unsigned char value) {
+    unsigned char saveGIE = INTCONbits.GIE;
+
+    EEADRH = addr >> 8;
+    EEADR = addr & 0xFF;
+    EEDATA = value;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.CFGS = 0;
+    EECON1bits.WREN = 1;
+
+    INTCONbits.GIE = 0;
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;
+    INTCONbits.GIE = saveGIE;
+
+    EECON1bits.WREN = 0;
+}
+
+unsigned char lstore_crc(unsigned char * rec) {
+    unsigned char crc = 0;
+    unsigned char i;
+
+    for (i=0; i<LSTORE_CRC; i++) {
+        crc = tlm_crc8(crc, rec[i]);
+    }
+    return crc;
+}
+
+//Finds the newest valid record. Live sequence numbers span fewer than 128
+//values, so a signed difference orders them across the wrap.
+unsigned char lstore_load(void) {
+    unsigned char rec[LSTORE_RECORD];
+    unsigned char found = 0;
+    unsigned char slot;
+    unsigned char i;
+
+    for (slot=0; slot<LSTORE_SLOTS; slot++) {
+        for (i=0; i<LSTORE_RECORD; i++) {
+            rec[i] = lstore_readByte(LSTORE_BASE + slot*LSTORE_SLOT + i);
+        }
+        if (rec[LSTORE_CRC] != lstore_crc(rec)) continue;
+        if (found && (signed char)(rec[LSTORE_SEQ] - lstore_saved[LSTORE_SEQ]) <= 0) continue;
+
+        for (i=0; i<LSTORE_RECORD; i++) {
+            lstore_saved[i] = rec[i];
+        }
+        lstore_slot = slot;
+        found = 1;
+    }
+
+    if (!found) lstore_saved[LSTORE_ID] = NET_NONE;
+    return found;
+}
+
+//Call after nrf_boot(). Returns 1 if there was a slot for this role, which
+//the next join then asks for again; the radio settings are taken over either
+//way.
+unsigned char lstore_restore(unsigned char role) {
+    lstore_role = role;
+    lstore_written = LSTORE_RECORD;
+
+    if (!lstore_load()) return 0;
+
+    if (lstore_saved[LSTORE_CHANNEL] <= 125) nrfs_write(RF_CH, lstore_saved[LSTORE_CHANNEL]);
+    nrfs_write(RF_SETUP, lstore_saved[LSTORE_SETUP]);
+
+    if (lstore_saved[LSTORE_ROLE] != role || lstore_saved[LSTORE_ID] == NET_NONE) return 0;
+
+    join_resume(lstore_saved[LSTORE_VIA],
+                lstore_saved[LSTORE_NONCE] | (unsigned int)lstore_saved[LSTORE_NONCE+1] << 8);
+    return 1;
+}
+
+//Periodic: notices a changed link state and writes it out a byte at a time
+void lstore_task(void) {
+    unsigned int addr;
+    unsigned char i;
+
+    if (EECON1bits.WR) return;
+
+    if (lstore_written < LSTORE_RECORD) {
+        addr = LSTORE_BASE + lstore_slot*LSTORE_SLOT + lstore_written;
+        lstore_writeByte(addr, lstore_pending[lstore_written]);
+        if (++lstore_written == LSTORE_RECORD) {
+            for (i=0; i<LSTORE_RECORD; i++) {
+                lstore_saved[i] = lstore_pending[i];
+            }
+        }
+        return;
+    }
+
+    //nothing worth keeping while unassigned
+    if (join_id == NET_NONE) return;
+
+    lstore_pending[LSTORE_ROLE] = lstore_role;
+    lstore_pending[LSTORE_CHANNEL] = nrfs_read(RF_CH);
+    lstore_pending[LSTORE_SETUP] = nrfs_read(RF_SETUP);
+    lstore_pending[LSTORE_ID] = join_id;
+    lstore_pending[LSTORE_VIA] = join_via;
+    lstore_pending[LSTORE_NONCE] = join_nonce & 0xFF;
+    lstore_pending[LSTORE_NONCE+1] = join_nonce >> 8;
+
+    for (i=LSTORE_ROLE; i<LSTORE_CRC; i++) {
+        if (lstore_pending[i] != lstore_saved[i]) break;
+    }
+    if (i == LSTORE_CRC) return;
+
+    lstore_pending[LSTORE_SEQ] = lstore_saved[LSTORE_SEQ] + 1;
+    lstore_pending[LSTORE_CRC] = lstore_crc(lstore_pending);
+    if (++lstore_slot >= LSTORE_SLOTS) lstore_slot = 0;
+    lstore_written = 0;
+}
+
+//The id the bootloader listens on (see bootloader.h)
+unsigned char lstore_boardId(void) {
+    unsigned char id = lstore_readByte(BL_EE_ID);
+
+    if (id == 0xFF) return BL_ID;
+    return id;
+}
+
+//Resets into the bootloader, which then waits BL_REQUEST_MS for an updater
+void lstore_bootRequest(void) {
+    while (EECON1bits.WR);
+    lstore_writeByte(BL_EE_FLAGS, BL_EE_REQUEST);
+    while (EECON1bits.WR);
+    asm("RESET");
+}
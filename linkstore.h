@@ -0,0 +1,27 @@
+// Link state kept in the PIC's data EEPROM across resets: radio channel and
+// setup, plus the slot a client was assigned. Records rotate through
+// LSTORE_SLOTS slots so no one cell takes every write; the newest is the
+// valid one with the highest sequence number. A record is only written when
+// the state changes, one byte per lstore_task() call, CRC last, so a reset
+// mid-write leaves the previous record in charge.
+
+#define LSTORE_BASE     0x000   // first data EEPROM address used (the top
+                                // bytes belong to the bootloader)
+#define LSTORE_SLOTS    32
+#define LSTORE_SLOT     16      // bytes per slot
+
+//Record layout
+#define LSTORE_SEQ      0
+#define LSTORE_ROLE     1
+#define LSTORE_CHANNEL  2       // RF_CH
+#define LSTORE_SETUP    3       // RF_SETUP (rate, power)
+#define LSTORE_ID       4
+#define LSTORE_VIA      5
+#define LSTORE_NONCE    6       // lo, hi
+#define LSTORE_CRC      8       // tlm_crc8 over the bytes before it
+#define LSTORE_RECORD   9
+
+unsigned char lstore_restore(unsigned char role);
+void lstore_task(void);
+unsigned char lstore_boardId(void);
+void lstore_bootRequest(void);
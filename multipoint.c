@@ -5,6 +5,12 @@
 #include "config.h"
 #include "serlcd.h"
 #include "nRF2401.h"
+#include "telemetry.h"
+#include "nrf_shadow.h"
+#include "nrf_boot.h"
+#include "sched.h"
+#include "sniffer.h"
+#include "strip.h"
 
 #define LED_GREEN_TRIS TRISBbits.TRISB4
 #define LED_GREEN PORTBbits.RB4
@@ -34,9 +40,6 @@ void setup(void);
 void run(void);
 void interruptService(void);
 
-////                            Shared Code                                 ////
-void delay(void);
-
 ////                            System Code                                 ////
 void main(void);
 void interrupt interrupt_high(void);
@@ -103,7 +106,7 @@ void setup(void) {
     BAUDCON1bits.BRG16 = 0;
     TXSTA1bits.BRGH = 1;
 
-    // 19.2kbaud = 001, 832
+    // 64MHz / (16 * (34 + 1)) = 114.3kbaud, 0.8% off the host side 115200
     SPBRG1 = 34;
     
     //9.6kbaud = 000, 103
@@ -115,83 +118,118 @@ void setup(void) {
 ////                            Sender Code                                 ////
 ////                                                                        ////
 ////////////////////////////////////////////////////////////////////////////////
-void dumpNrf(void) {
-    int i;
-    char val;
-    for (int i=0; i<=0x1d; i++) {
-        val = nrf_readRegister(i);
-        sendHex(i);
-        sendLiteralBytes("\t");
-        sendHex(val);
-        sendLiteralBytes("\n");
+#define RADIO_PERIOD    SCHED_MS(40)
+#define REPORT_PERIOD   SCHED_MS(1000)
+#define RENDER_PERIOD   SCHED_MS(33)    // 510 LEDs take ~17ms to clock out
+
+void reportTask(void) {
+    tlm_flushStatus();
+    sched_report();
+}
+
+unsigned int rxCount[8];    //payloads per pipe, live and replayed
+
+void reportReceive(void) {
+    tlm_sendCounters(rxCount, 6);
+    tlm_sendProfile(STRIP_PROFILE_ID, strip_gapMax);
+    strip_gapMax = 0;
+    reportTask();
+}
+
+strip_generator frameSource = strip_genGradient;
+
+void receiveHandle(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    rxCount[pipe & 0x07]++;
+
+    switch (buf[0]) {
+        case STRIP_MSG_OFFSET:
+            if (len < 2) break;
+            strip_offset = buf[1];
+            frameSource = strip_genGradient;
+            break;
+        case STRIP_MSG_RUNS:
+            strip_setRuns(buf, len);
+            frameSource = strip_genRuns;
+            break;
+        case STRIP_MSG_LEVEL:
+            if (len < 5) break;
+            strip_correction[0] = buf[2];
+            strip_correction[1] = buf[3];
+            strip_correction[2] = buf[4];
+            if (buf[1] <= STRIP_LUT_RAW) strip_setLevel(buf[1]);
+            break;
     }
 }
 
-void run(void) {
-    int i;
-    short nextSlot;
+void renderTask(void) {
+    strip_render(frameSource);
+}
+
+void receiveTask(void) {
     char status;
+    unsigned char pipe;
+    unsigned char len;
 
-    nrf_init();
-    delay();
+    LED_RED++;
+    status = nrf_getStatus();
 
-    nrf_rxmode();
-    delay();
+    LED_GREEN = 0;
+    while ((len = sniff_next(rx_buf, &pipe)) != 0) {
+        receiveHandle(pipe, rx_buf, len);
+        LED_GREEN = 1;
+    }
+    tlm_noteStatus(status, LED_GREEN);
+}
+
+void run(void) {
+    nrf_bootRx();
 
     //nrf_setTxAddr(0);
     //nrf_setRxAddr(0,0);
 
     sendLiteralBytes("Receiver!\n");
 
-    dumpNrf();
+    tlm_sendRegisters();
 
-    i=0;
-    while(1) {
-        LED_RED++;
-        sendIntDec(nrf_getStatus());
-        sendLiteralBytes("\n");
+    sniff_init(0);
+    strip_init();
 
-        LED_GREEN = nrf_receive(&tx_buf,&rx_buf);
-        delay();
-    }
+    sched_init();
+    sched_addPeriodic(receiveTask, 1);
+    sched_addPeriodic(renderTask, RENDER_PERIOD);
+    sched_addPeriodic(reportReceive, REPORT_PERIOD);
+    sched_run();
 }
 
-void runSend(void) {
-    nrf_init();
-    delay();
+void sendTask(void) {
+    char result;
+
+    LED_RED++;
+    result = nrf_send(&tx_buf,&rx_buf);
+    LED_GREEN = result;
+    tlm_noteStatus(nrf_getStatus(), result);
+}
 
-    nrf_txmode();
-    delay();
+void runSend(void) {
+    nrf_bootTx();
 
     //nrf_setTxAddr(0);
     //nrf_setRxAddr(0,0);
 
     sendLiteralBytes("Sender!\n");
 
-    dumpNrf();
+    tlm_sendRegisters();
 
     tx_buf[0] = 42;
-    while(1) {
-        LED_RED++;
-        LED_GREEN = nrf_send(&tx_buf,&rx_buf);
-        sendIntDec(nrf_getStatus());
-        sendLiteralBytes("\n");
-        delay();
-    }
-}
-
-void interruptService(void) {
 
+    sched_init();
+    sched_addPeriodic(sendTask, RADIO_PERIOD);
+    sched_addPeriodic(reportTask, REPORT_PERIOD);
+    sched_run();
 }
 
-////////////////////////////////////////////////////////////////////////////////
-////                                                                        ////
-////                            Shared Code                                 ////
-////                                                                        ////
-////////////////////////////////////////////////////////////////////////////////
-
-void delay(void) {
-    Delay10KTCYx(254);
+void interruptService(void) {
+    tlm_rxService();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -214,6 +252,8 @@ void main(void) {
 }
 
 void interrupt interrupt_high(void) {
+    if (INTCONbits.TMR0IF) sched_tick();
+
     interruptService();
 
     INTCONbits.TMR0IF = CLEAR;
@@ -0,0 +1,164 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "telemetry.h"
+#include "sniffer.h"
+#include "net.h"
+
+unsigned char net_self = NET_MASTER;
+unsigned char net_parent = NET_MASTER;
+unsigned char net_relaying = 0;
+unsigned char net_seq = 0;
+
+unsigned char net_dupSrc[NET_DUP_CACHE];
+unsigned char net_dupSeq[NET_DUP_CACHE];
+unsigned char net_dupNext = 0;
+
+unsigned char net_routeNode[NET_ROUTES];
+unsigned char net_routeVia[NET_ROUTES];
+unsigned char net_routeHops[NET_ROUTES];
+unsigned char net_routeNext = 0;
+
+unsigned char net_ack[MAX_PAYLOAD];
+
+//A relay listens on its relay address (pipe 1) and its own id (pipe 2), and
+//keeps pipe 0 for auto-ack replies while it transmits
+void net_init(unsigned char self, unsigned char parent, unsigned char relaying) {
+    unsigned char i;
+
+    net_self = self;
+    net_parent = parent;
+    net_relaying = relaying;
+
+    for (i=0; i<NET_DUP_CACHE; i++) {
+        net_dupSrc[i] = NET_NONE;
+    }
+    for (i=0; i<NET_ROUTES; i++) {
+        net_routeNode[i] = NET_NONE;
+    }
+
+    if (relaying) {
+        nrfs_enablePipe(1);
+        nrfs_setRxAddr(1, NET_RELAY_ADDR(self));
+        nrfs_enablePipe(2);
+        nrfs_setRxAddr(2, self);
+        nrfs_clearBits(EN_RXADDR, 0x01);
+    }
+}
+
+void net_header(unsigned char * buf, unsigned char dst) {
+    buf[NET_DST] = dst;
+    buf[NET_SRC] = net_self;
+    buf[NET_LAST] = net_self;
+    buf[NET_HOPS] = 0;
+    buf[NET_SEQ] = net_seq++;
+}
+
+//Returns 1 if (src, seq) was already seen, otherwise remembers it
+unsigned char net_seen(unsigned char src, unsigned char seq) {
+    unsigned char i;
+
+    for (i=0; i<NET_DUP_CACHE; i++) {
+        if (net_dupSrc[i] == src && net_dupSeq[i] == seq) return 1;
+    }
+
+    net_dupSrc[net_dupNext] = src;
+    net_dupSeq[net_dupNext] = seq;
+    net_dupNext = (net_dupNext + 1) & (NET_DUP_CACHE - 1);
+    return 0;
+}
+
+unsigned char net_findRoute(unsigned char node) {
+    unsigned char i;
+
+    for (i=0; i<NET_ROUTES; i++) {
+        if (net_routeNode[i] == node) return i;
+    }
+    return NET_NONE;
+}
+
+//Latest frame wins, so a node that moves behind a relay is picked up at once
+void net_learn(unsigned char node, unsigned char via, unsigned char hops) {
+    unsigned char i;
+
+    if (node == net_self) return;
+
+    i = net_findRoute(node);
+    if (i == NET_NONE) {
+        i = net_routeNext;
+        net_routeNext = (net_routeNext + 1) & (NET_ROUTES - 1);
+        net_routeNode[i] = node;
+    }
+    net_routeVia[i] = via;
+    net_routeHops[i] = hops;
+}
+
+unsigned char net_nextHop(unsigned char dst) {
+    unsigned char i;
+
+    if (dst == NET_MASTER) return net_parent;
+
+    i = net_findRoute(dst);
+    if (i == NET_NONE) return dst;
+    return net_routeVia[i];
+}
+
+unsigned char net_accept(unsigned char * buf, unsigned char len) {
+    if (len < NET_HEADER) return NET_DROP;
+    if (net_seen(buf[NET_SRC], buf[NET_SEQ])) return NET_DROP;
+
+    net_learn(buf[NET_SRC], buf[NET_LAST], buf[NET_HOPS]);
+
+    if (buf[NET_DST] == net_self) return NET_LOCAL;
+    if (!net_relaying || buf[NET_HOPS] >= NET_MAX_HOPS) return NET_DROP;
+    return NET_FORWARD;
+}
+
+//buf must be MAX_PAYLOAD long. A relay drops out of RX for the send; any ACK
+//payload still queued would otherwise go out as a packet, so the FIFO is
+//emptied and the default ACK payloads for its children go back in after.
+unsigned char net_send(unsigned char * buf) {
+    unsigned char result;
+
+    if (net_relaying) {
+        nrfs_txmode();
+        nrfs_setBits(EN_RXADDR, 0x01);
+        sniff_ackFlush();
+    }
+
+    nrfs_setTxAddr(net_nextHop(buf[NET_DST]));
+    result = nrf_send(buf, net_ack);
+
+    if (net_relaying) {
+        //pipe 0 now carries the TX address; don't ack frames meant for it
+        nrfs_clearBits(EN_RXADDR, 0x01);
+        nrfs_rxmode();
+        sniff_ackFill();
+    }
+    return result;
+}
+
+unsigned char net_forward(unsigned char * buf) {
+    buf[NET_HOPS]++;
+    buf[NET_LAST] = net_self;
+    return net_send(buf);
+}
+
+void net_sendRoutes(void) {
+    unsigned char i;
+    unsigned char n = 0;
+
+    for (i=0; i<NET_ROUTES; i++) {
+        if (net_routeNode[i] != NET_NONE) n++;
+    }
+
+    tlm_begin(TLM_ROUTES, n*3);
+    for (i=0; i<NET_ROUTES; i++) {
+        if (net_routeNode[i] == NET_NONE) continue;
+        tlm_put(net_routeNode[i]);
+        tlm_put(net_routeVia[i]);
+        tlm_put(net_routeHops[i]);
+    }
+    tlm_end();
+}
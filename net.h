@@ -0,0 +1,52 @@
+// Store-and-forward framing for the multipoint network. Every payload starts
+// with a small header. Relays pass frames on with the hop count bumped, drop
+// anything they have already seen (src, seq), and every node that hears a
+// frame learns which neighbour leads back to its source. Node ids double as
+// radio address ids (NRFS_ADDR LSByte). Each relay also listens on a relay
+// address of its own, and a node's parent is either its slot address at the
+// master or some relay's address, so relays can chain.
+
+#define NET_HEADER      5
+#define NET_DST         0
+#define NET_SRC         1
+#define NET_LAST        2       // node that transmitted this copy
+#define NET_HOPS        3       // forwards so far
+#define NET_SEQ         4       // per source
+#define NET_DATA        NET_HEADER
+
+#define NET_MASTER      0x00
+#define NET_RELAY       0x10    // relay addresses, NET_RELAY | slot
+#define NET_SLAVE       0x20    // slave ids start here
+#define NET_NONE        0xFF
+
+#define NET_RELAY_ADDR(id)  (NET_RELAY | ((id) & 0x0F))
+
+#define NET_MAX_HOPS    3
+#define NET_DUP_CACHE   8
+#define NET_ROUTES      8
+#define NET_FAIL_LIMIT  4       // failed sends before a slave switches parent
+
+//net_accept() results
+#define NET_DROP        0
+#define NET_LOCAL       1
+#define NET_FORWARD     2
+
+extern unsigned char net_self;
+extern unsigned char net_parent;    // address frames for the master go to
+extern unsigned char net_relaying;
+extern unsigned char net_ack[];    // ACK payload of the last net_send()
+
+extern unsigned char net_routeNode[NET_ROUTES];
+extern unsigned char net_routeVia[NET_ROUTES];
+extern unsigned char net_routeHops[NET_ROUTES];
+
+void net_init(unsigned char self, unsigned char parent, unsigned char relaying);
+void net_header(unsigned char * buf, unsigned char dst);
+
+void net_learn(unsigned char node, unsigned char via, unsigned char hops);
+unsigned char net_nextHop(unsigned char dst);
+unsigned char net_accept(unsigned char * buf, unsigned char len);
+
+unsigned char net_send(unsigned char * buf);
+unsigned char net_forward(unsigned char * buf);
+void net_sendRoutes(void);
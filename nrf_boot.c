@@ -0,0 +1,83 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "nrf_boot.h"
+#include "tick.h"
+
+//Register writes (reg < 0x20) go through the shadow so it starts out coherent,
+//anything else is sent as a raw command/argument pair. CONFIG stays powered
+//down until the whole table is in.
+const unsigned char nrf_bootTable[] = {
+    CONFIG,         0x0C,
+    EN_AA,          0x01,
+    EN_RXADDR,      0x01,
+    SETUP_RETR,     0x33,   // 1000us + 86us, 3 retransmits
+    RF_CH,          NRF_DEFAULT_CHANNEL,
+    RF_SETUP,       NRF_DEFAULT_SETUP,
+    RX_PW_P0,       MAX_PAYLOAD,
+    FEATURE,        0x06,   // dynamic payload length, ACK payloads
+    DYNPD,          0x01,
+    STATUS,         RX_DR | TX_DS | MAX_RT,
+    FLUSH_TX,       0,
+    FLUSH_RX,       0,
+};
+
+void nrf_spiSetup(void) {
+    SPI_STATUS = 0b00000000;
+    SPI_CLK_EDGE = 1;   //clock on idle to active clk trans
+    SPI_CONFIG_1 = SPI_CONFIG_1_VALUE;
+    SPI_CLK_POL = 0;    //clock polarity, idle low
+    SPI_ENABLE = SET;
+
+    CE = CLEAR;
+    CSN = SET;
+}
+
+void nrf_boot(unsigned char config) {
+    unsigned char i;
+    unsigned char reg;
+
+    nrf_spiSetup();
+    nrfs_invalidate();
+
+    //The radio only needs the long reset wait when it was powered up with us
+    if (!RCONbits.POR) {
+        tick_waitMs(NRF_TPOR_MS);
+        RCONbits.POR = 1;
+    }
+
+    for (i=0; i<sizeof(nrf_bootTable); i+=2) {
+        reg = nrf_bootTable[i];
+        if (reg < WRITE_REG) {
+            nrfs_write(reg, nrf_bootTable[i+1]);
+        } else {
+            nrf_SPI_RW_Reg(reg, nrf_bootTable[i+1]);
+        }
+    }
+
+    //Plain nRF24L01 parts need FEATURE unlocked before it can be written
+    if (nrf_SPI_Read(FEATURE) != nrfs_read(FEATURE)) {
+        nrf_SPI_RW_Reg(ACTIVATE, 0x73);
+        nrf_SPI_RW_Reg(WRITE_REG + FEATURE, nrfs_read(FEATURE));
+        nrf_SPI_RW_Reg(WRITE_REG + DYNPD, nrfs_read(DYNPD));
+    }
+
+    nrfs_setTxAddr(NRF_DEFAULT_ID);
+
+    nrfs_write(CONFIG, config);
+    tick_waitUs(NRF_TPD2STBY_US);
+
+    if (config & PRIM_RX) {
+        CE = SET;
+        tick_waitUs(NRF_TSTBY2A_US);
+    }
+}
+
+void nrf_bootRx(void) {
+    nrf_boot(NRF_CONFIG_RX);
+}
+
+void nrf_bootTx(void) {
+    nrf_boot(NRF_CONFIG_TX);
+}
@@ -0,0 +1,17 @@
+// Radio bring-up from a program memory table of register/value pairs,
+// waiting only the datasheet settling times.
+
+#define NRF_DEFAULT_ID      0x34    // LSByte of the old TX_ADDRESS
+#define NRF_DEFAULT_CHANNEL 40
+#define NRF_DEFAULT_SETUP   0x07    // 0dBm, 1Mbps, LNA HCURR
+
+#define NRF_CONFIG_TX       0x0E    // PWR_UP, 2 byte CRC
+#define NRF_CONFIG_RX       0x0F    // PWR_UP, 2 byte CRC, PRIM_RX
+
+#define NRF_TPOR_MS         100     // power on reset, first boot only
+#define NRF_TPD2STBY_US     1500    // power down -> standby
+#define NRF_TSTBY2A_US      130     // standby -> RX/TX settling
+
+void nrf_boot(unsigned char config);
+void nrf_bootRx(void);
+void nrf_bootTx(void);
@@ -0,0 +1,147 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+
+unsigned char nrfs_value[NRFS_REGISTERS];
+unsigned char nrfs_flags[NRFS_REGISTERS];
+
+//LSByte of RX_ADDR_P0, RX_ADDR_P1 and TX_ADDR, valid per bit of nrfs_addrValid
+unsigned char nrfs_addrId[3];
+unsigned char nrfs_addrValid = 0;
+
+unsigned int nrfs_transactions = 0;
+
+void nrfs_invalidate(void) {
+    unsigned char i;
+
+    for (i=0; i<NRFS_REGISTERS; i++) {
+        nrfs_flags[i] = 0;
+    }
+    nrfs_addrValid = 0;
+}
+
+//Registers the radio changes on its own are never cached
+unsigned char nrfs_cacheable(unsigned char reg) {
+    switch (reg) {
+        case STATUS:
+        case 0x08:  //OBSERVE_TX
+        case 0x09:  //RPD
+        case RX_ADDR_P0:
+        case RX_ADDR_P1:
+        case TX_ADDR:
+        case FIFO_STATUS:
+            return 0;
+    }
+    return reg < NRFS_REGISTERS;
+}
+
+unsigned char nrfs_read(unsigned char reg) {
+    if (!nrfs_cacheable(reg)) {
+        nrfs_transactions++;
+        return nrf_SPI_Read(reg);
+    }
+
+    if (!(nrfs_flags[reg] & NRFS_VALID)) {
+        nrfs_transactions++;
+        nrfs_value[reg] = nrf_SPI_Read(reg);
+        nrfs_flags[reg] = NRFS_VALID;
+    }
+    return nrfs_value[reg];
+}
+
+void nrfs_write(unsigned char reg, unsigned char value) {
+    if (nrfs_cacheable(reg)) {
+        if ((nrfs_flags[reg] & NRFS_VALID) && nrfs_value[reg] == value) {
+            nrfs_flags[reg] &= ~NRFS_DIRTY;
+            return;
+        }
+        nrfs_value[reg] = value;
+        nrfs_flags[reg] = NRFS_VALID;
+    }
+
+    nrfs_transactions++;
+    nrf_SPI_RW_Reg(WRITE_REG + reg, value);
+}
+
+//Updates the shadow only; the radio sees it on the next nrfs_flush()
+void nrfs_stage(unsigned char reg, unsigned char value) {
+    if (!nrfs_cacheable(reg)) {
+        nrfs_write(reg, value);
+        return;
+    }
+
+    if ((nrfs_flags[reg] & NRFS_VALID) && nrfs_value[reg] == value) return;
+
+    nrfs_value[reg] = value;
+    nrfs_flags[reg] = NRFS_VALID | NRFS_DIRTY;
+}
+
+void nrfs_flush(void) {
+    unsigned char i;
+
+    for (i=0; i<NRFS_REGISTERS; i++) {
+        if (nrfs_flags[i] & NRFS_DIRTY) {
+            nrfs_flags[i] = NRFS_VALID;
+            nrfs_transactions++;
+            nrf_SPI_RW_Reg(WRITE_REG + i, nrfs_value[i]);
+        }
+    }
+}
+
+void nrfs_setBits(unsigned char reg, unsigned char mask) {
+    nrfs_write(reg, nrfs_read(reg) | mask);
+}
+
+void nrfs_clearBits(unsigned char reg, unsigned char mask) {
+    nrfs_write(reg, nrfs_read(reg) & ~mask);
+}
+
+//Writes a 5 byte node address to RX_ADDR_P0, RX_ADDR_P1 or TX_ADDR
+void nrfs_writeAddr(unsigned char reg, unsigned char id) {
+    unsigned char addr[NRFS_ADDR_WIDTH] = NRFS_ADDR;
+    unsigned char slot;
+
+    if (reg == TX_ADDR) slot = 2;
+    else slot = reg - RX_ADDR_P0;
+
+    if ((nrfs_addrValid & (1 << slot)) && nrfs_addrId[slot] == id) return;
+
+    addr[0] = id;
+    nrfs_transactions++;
+    nrf_SPI_Write_Buf(WRITE_REG + reg, addr, NRFS_ADDR_WIDTH);
+    nrfs_addrId[slot] = id;
+    nrfs_addrValid |= 1 << slot;
+}
+
+//Pipe 0 follows the TX address so auto-ack replies are received
+void nrfs_setTxAddr(unsigned char id) {
+    nrfs_writeAddr(TX_ADDR, id);
+    nrfs_writeAddr(RX_ADDR_P0, id);
+}
+
+//Pipes 2-5 share the upper bytes of pipe 1 and only carry the LSByte
+void nrfs_setRxAddr(unsigned char pipe, unsigned char id) {
+    if (pipe < 2) {
+        nrfs_writeAddr(RX_ADDR_P0 + pipe, id);
+    } else {
+        nrfs_write(RX_ADDR_P0 + pipe, id);
+    }
+}
+
+void nrfs_enablePipe(unsigned char pipe) {
+    nrfs_setBits(EN_RXADDR, 1 << pipe);
+    nrfs_setBits(EN_AA, 1 << pipe);
+    nrfs_setBits(DYNPD, 1 << pipe);
+}
+
+//A mode switch is a single CONFIG write, or nothing if already in that mode
+void nrfs_txmode(void) {
+    CE = CLEAR;
+    nrfs_write(CONFIG, (nrfs_read(CONFIG) & ~PRIM_RX) | PWR_UP);
+}
+
+void nrfs_rxmode(void) {
+    nrfs_write(CONFIG, nrfs_read(CONFIG) | PRIM_RX | PWR_UP);
+    CE = SET;
+}
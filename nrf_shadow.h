@@ -0,0 +1,43 @@
+// RAM shadow of the nRF24L01 configuration registers. Reads are served from
+// RAM once a register is known, writes are skipped when the value is already
+// there, and staged writes go out together on nrfs_flush(). Anything that
+// talks to the radio behind the shadow's back (nrf_init, nrf_txmode, ...)
+// must be followed by nrfs_invalidate().
+
+#define NRFS_REGISTERS  0x1E    // 0x00 - 0x1D
+#define NRFS_ADDR_WIDTH 5
+
+#define NRFS_VALID      0x01
+#define NRFS_DIRTY      0x02
+
+#ifndef PRIM_RX
+#define PRIM_RX         0x01
+#define PWR_UP          0x02
+#endif
+
+#ifndef RX_ADDR_P1
+#define RX_ADDR_P1      0x0B
+#endif
+
+//Node addresses share the upper four bytes; the node id is the LSByte (the
+//byte pipes 2-5 are allowed to differ in). Id 0x34 is the old TX_ADDRESS.
+#define NRFS_ADDR       {0x00,0x43,0x10,0x10,0x01}
+
+extern unsigned int nrfs_transactions;
+
+void nrfs_invalidate(void);
+
+unsigned char nrfs_read(unsigned char reg);
+void nrfs_write(unsigned char reg, unsigned char value);
+void nrfs_stage(unsigned char reg, unsigned char value);
+void nrfs_flush(void);
+void nrfs_setBits(unsigned char reg, unsigned char mask);
+void nrfs_clearBits(unsigned char reg, unsigned char mask);
+
+void nrfs_writeAddr(unsigned char reg, unsigned char id);
+void nrfs_setTxAddr(unsigned char id);
+void nrfs_setRxAddr(unsigned char pipe, unsigned char id);
+void nrfs_enablePipe(unsigned char pipe);
+
+void nrfs_txmode(void);
+void nrfs_rxmode(void);
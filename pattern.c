@@ -0,0 +1,128 @@
+#include <xc.h>
+#include "constants.h"
+#include "eeprom.h"
+#include "strip.h"
+#include "pattern.h"
+
+unsigned char pat_count = 0;
+
+unsigned char pat_current = 0;
+unsigned int pat_start;             // address of frame 0
+unsigned char pat_frames;
+unsigned char pat_hold;
+unsigned char pat_frame;
+unsigned char pat_held;
+unsigned char pat_runs;             // run count of the current frame
+
+unsigned char pat_pending[PAT_PENDING][PAT_WRITE_MAX];
+unsigned int pat_pendAddr[PAT_PENDING];
+unsigned char pat_pendLen[PAT_PENDING];
+unsigned char pat_pendHead = 0;
+unsigned char pat_pendCount = 0;
+unsigned char pat_pendDone = 0;     // bytes of the head entry already written
+unsigned char pat_reload = 0;       // directory page was written
+
+void pat_init(void) {
+    unsigned char dir[2];
+
+    ee_read(0, dir, 2);
+
+    pat_count = 0;
+    if (dir[0] == PAT_MAGIC && dir[1] <= PAT_MAX) pat_count = dir[1];
+    pat_select(0);
+}
+
+void pat_loadFrame(void) {
+    pat_runs = ee_readByte(pat_start + (unsigned int)pat_frame * PAT_FRAME_BYTES);
+    if (pat_runs > PAT_FRAME_RUNS) pat_runs = 0;
+}
+
+unsigned char pat_select(unsigned char n) {
+    unsigned char entry[PAT_DIR_ENTRY];
+
+    if (n >= pat_count) return 0;
+
+    ee_read(2 + n*PAT_DIR_ENTRY, entry, PAT_DIR_ENTRY);
+    pat_current = n;
+    pat_start = ((unsigned int)entry[0] << 8 | entry[1]) * EE_PAGE;
+    pat_frames = entry[2];
+    pat_hold = entry[3] ? entry[3] : 1;
+    pat_frame = 0;
+    pat_held = 0;
+    pat_loadFrame();
+    return 1;
+}
+
+//Called once per frame period. The part can't be read during a write cycle,
+//so while patterns are loading the current frame is simply held.
+void pat_next(void) {
+    if (pat_count == 0 || ee_busy() || ++pat_held < pat_hold) return;
+
+    pat_held = 0;
+    if (++pat_frame >= pat_frames) pat_frame = 0;
+    pat_loadFrame();
+}
+
+//txq_filler: slice n of the current frame as a STRIP_MSG_RUNS payload, read
+//in one burst
+unsigned char pat_slice(unsigned char n, unsigned char * buf) {
+    unsigned char first = n * STRIP_RUNS_PER_MSG;
+    unsigned char count;
+
+    if (pat_count == 0 || first >= pat_runs) return 0;
+    count = pat_runs - first;
+    if (count > STRIP_RUNS_PER_MSG) count = STRIP_RUNS_PER_MSG;
+
+    buf[0] = STRIP_MSG_RUNS;
+    buf[1] = first;
+    buf[2] = count;
+
+    //the transfer starts between write cycles (see frameTask in serialrelay.c),
+    //but pat_task() may have started a page since: wait that one out
+    while (ee_busy());
+    ee_read(pat_start + (unsigned int)pat_frame * PAT_FRAME_BYTES + 1 + first*4, buf + 3, count*4);
+    return 3 + count*4;
+}
+
+//Queues a write; returns 0 if the queue is full
+unsigned char pat_write(unsigned int addr, unsigned char * data, unsigned char len) {
+    unsigned char slot;
+    unsigned char i;
+
+    if (len == 0 || len > PAT_WRITE_MAX || pat_pendCount >= PAT_PENDING) return 0;
+
+    slot = (pat_pendHead + pat_pendCount) % PAT_PENDING;
+    for (i=0; i<len; i++) {
+        pat_pending[slot][i] = data[i];
+    }
+    pat_pendAddr[slot] = addr;
+    pat_pendLen[slot] = len;
+    pat_pendCount++;
+    return 1;
+}
+
+//Starts at most one page write per call, never waits for the write cycle
+void pat_task(void) {
+    unsigned char n;
+
+    if (pat_pendCount == 0) {
+        if (pat_reload && !ee_busy()) {
+            pat_reload = 0;
+            pat_init();
+        }
+        return;
+    }
+
+    if (pat_pendAddr[pat_pendHead] < EE_PAGE) pat_reload = 1;
+
+    n = ee_write(pat_pendAddr[pat_pendHead] + pat_pendDone,
+                 pat_pending[pat_pendHead] + pat_pendDone,
+                 pat_pendLen[pat_pendHead] - pat_pendDone);
+    pat_pendDone += n;
+
+    if (pat_pendDone < pat_pendLen[pat_pendHead]) return;
+
+    pat_pendDone = 0;
+    pat_pendHead = (pat_pendHead + 1) % PAT_PENDING;
+    pat_pendCount--;
+}
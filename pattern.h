@@ -0,0 +1,38 @@
+// Animations stored in the external EEPROM. Page 0 is the directory:
+//
+//   magic, count, then per pattern: first page (hi, lo), frames, hold
+//
+// and every frame is PAT_FRAME_BYTES long: a run count followed by up to
+// PAT_FRAME_RUNS runs of count, g, r, b (the STRIP_MSG_RUNS format). A
+// frame is read straight into bulk transfer slices, so nothing bigger than
+// one slice is held in RAM. hold is the number of frame periods each frame
+// stays up.
+//
+// New patterns are written with pat_write(), from TLM_EEWRITE frames over
+// UART or PAT_MSG_WRITE payloads over RF; pat_task() commits them a page
+// piece at a time whenever the EEPROM is idle. A receiver answers every RF
+// write in its ACK payloads (PAT_MSG_STATUS with the write's tag), and the
+// sender only acks the host once that answer is back.
+
+#define PAT_MAGIC           0xA7
+#define PAT_MAX             15
+#define PAT_DIR_ENTRY       4
+#define PAT_FRAME_BYTES     128
+#define PAT_FRAME_RUNS      31
+
+#define PAT_WRITE_MAX       32
+#define PAT_PENDING         2
+
+#define PAT_MSG_WRITE       0x57    // tag, addr lo, addr hi, data (RF)
+#define PAT_MSG_STATUS      0x53    // tag, TLM_EE_* (receiver's ACK payload)
+#define PAT_FORWARD         0x01    // TLM_EEWRITE flag: pass the write on over RF
+
+extern unsigned char pat_count;
+
+void pat_init(void);
+unsigned char pat_select(unsigned char n);
+void pat_next(void);
+unsigned char pat_slice(unsigned char n, unsigned char * buf);
+
+unsigned char pat_write(unsigned int addr, unsigned char * data, unsigned char len);
+void pat_task(void);
@@ -0,0 +1,78 @@
+#include <xc.h>
+#include "constants.h"
+#include "pot.h"
+
+volatile unsigned int pot_acc = 0;
+volatile unsigned char pot_count = 0;
+volatile unsigned char pot_busy = 0;
+volatile unsigned int pot_value = 0;
+volatile unsigned char pot_new = 0;
+
+void pot_init(void) {
+    TRISAbits.TRISA3 = INPUT;
+    ANCON0 |= 1 << POT_CHANNEL;
+
+    ADCON1 = 0b00000000;            //AVdd/AVss references, negative input AVss
+    ADCON2bits.ADFM = 1;            //right justified
+    ADCON2bits.ACQT = 0b010;        //4 TAD acquisition
+    ADCON2bits.ADCS = 0b110;        //Fosc/64
+    ADCON0 = (POT_CHANNEL << 2) | 0b01;    //select channel, ADON
+
+    pot_acc = 0;
+    pot_count = 0;
+    pot_busy = 0;
+
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+}
+
+//Called from the Timer0 interrupt; starts a new burst once the last one is done
+void pot_tick(void) {
+    if (pot_busy) return;
+
+    pot_busy = 1;
+    ADCON0bits.GO = 1;
+}
+
+//Called from the interrupt handler
+void pot_service(void) {
+    unsigned int sample;
+    unsigned int diff;
+
+    if (!PIR1bits.ADIF) return;
+    PIR1bits.ADIF = 0;
+
+    pot_acc += ((unsigned int)ADRESH << 8) | ADRESL;
+    if (++pot_count < POT_OVERSAMPLE) {
+        ADCON0bits.GO = 1;
+        return;
+    }
+
+    sample = pot_acc >> POT_SHIFT;
+    pot_acc = 0;
+    pot_count = 0;
+    pot_busy = 0;
+
+    if (sample > pot_value) diff = sample - pot_value;
+    else diff = pot_value - sample;
+
+    if (diff > POT_HYSTERESIS || (sample == 0 && pot_value != 0) || (sample == POT_MAX && pot_value != POT_MAX)) {
+        pot_value = sample;
+        pot_new = 1;
+    }
+}
+
+unsigned char pot_ready(void) {
+    return pot_new;
+}
+
+unsigned int pot_read(void) {
+    unsigned int value;
+
+    PIE1bits.ADIE = 0;
+    value = pot_value;
+    pot_new = 0;
+    PIE1bits.ADIE = 1;
+
+    return value;
+}
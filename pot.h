@@ -0,0 +1,18 @@
+// Interrupt driven potentiometer sampling. Every Timer0 tick starts a burst of
+// POT_OVERSAMPLE back to back conversions; the ADC interrupt accumulates them
+// and decimates to 14 bits, and the result is only published when it moves
+// more than POT_HYSTERESIS from the last published value. The main loop
+// never waits on the converter.
+
+#define POT_CHANNEL     3       // AN3 / RA3
+#define POT_OVERSAMPLE  16      // 16 x 12 bit samples -> 14 bit result
+#define POT_SHIFT       2
+#define POT_HYSTERESIS  24      // in 14 bit counts
+#define POT_MAX         (4095 * POT_OVERSAMPLE >> POT_SHIFT)    // 16380
+
+void pot_init(void);
+void pot_tick(void);
+void pot_service(void);
+
+unsigned char pot_ready(void);
+unsigned int pot_read(void);
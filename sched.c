@@ -0,0 +1,149 @@
+#include <xc.h>
+#include "sched.h"
+#include "tick.h"
+#include "telemetry.h"
+
+sched_task sched_fn[SCHED_MAX_TASKS];
+unsigned int sched_period[SCHED_MAX_TASKS];
+volatile unsigned int sched_countdown[SCHED_MAX_TASKS];
+volatile unsigned char sched_pending[SCHED_MAX_TASKS];
+unsigned char sched_count = 0;
+
+//Run time accounting, in Timer0 counts (62.5ns); saturates at 0xFFFF
+unsigned int sched_maxRun[SCHED_MAX_TASKS];
+unsigned long sched_totalRun[SCHED_MAX_TASKS];
+unsigned int sched_runs[SCHED_MAX_TASKS];
+
+volatile unsigned int sched_ticks = 0;
+
+void sched_init(void) {
+    unsigned char saveGIE = INTCONbits.GIE;
+
+    INTCONbits.GIE = 0;
+    sched_count = 0;
+    INTCONbits.GIE = saveGIE;
+}
+
+unsigned char sched_add(sched_task fn, unsigned int period, unsigned int delay) {
+    unsigned char id;
+    unsigned char saveGIE;
+
+    if (sched_count >= SCHED_MAX_TASKS) return SCHED_NONE;
+
+    id = sched_count;
+    sched_fn[id] = fn;
+    sched_period[id] = period;
+    sched_maxRun[id] = 0;
+    sched_totalRun[id] = 0;
+    sched_runs[id] = 0;
+
+    saveGIE = INTCONbits.GIE;
+    INTCONbits.GIE = 0;
+    sched_countdown[id] = delay;
+    sched_pending[id] = 0;
+    sched_count++;
+    INTCONbits.GIE = saveGIE;
+
+    return id;
+}
+
+unsigned char sched_addPeriodic(sched_task fn, unsigned int period) {
+    return sched_add(fn, period, period);
+}
+
+unsigned char sched_addOneShot(sched_task fn, unsigned int delay) {
+    return sched_add(fn, 0, delay);
+}
+
+//Runs only when signalled
+unsigned char sched_addEvent(sched_task fn) {
+    return sched_add(fn, 0, 0);
+}
+
+//(Re)arms a task to run after delay ticks; 0 disarms it
+void sched_delay(unsigned char id, unsigned int delay) {
+    unsigned char saveGIE;
+
+    if (id >= sched_count) return;
+
+    saveGIE = INTCONbits.GIE;
+    INTCONbits.GIE = 0;
+    sched_countdown[id] = delay;
+    INTCONbits.GIE = saveGIE;
+}
+
+//Safe from interrupt context
+void sched_signal(unsigned char id) {
+    if (id < sched_count) sched_pending[id] = 1;
+}
+
+//Called from the Timer0 interrupt
+void sched_tick(void) {
+    unsigned char i;
+
+    sched_ticks++;
+    for (i=0; i<sched_count; i++) {
+        if (sched_countdown[i] != 0 && --sched_countdown[i] == 0) {
+            sched_pending[i] = 1;
+            sched_countdown[i] = sched_period[i];
+        }
+    }
+}
+
+//sched_ticks and Timer0 as one 32 bit count. Interrupts are held off so the
+//two belong together, and an overflow the ISR hasn't taken yet is counted.
+unsigned long sched_clock(void) {
+    unsigned char saveGIE = INTCONbits.GIE;
+    unsigned int ticks;
+    unsigned int now;
+
+    INTCONbits.GIE = 0;
+    ticks = sched_ticks;
+    now = tick_now();
+    if (INTCONbits.TMR0IF && now < 0x8000) ticks++;
+    INTCONbits.GIE = saveGIE;
+
+    return ((unsigned long)ticks << 16) | now;
+}
+
+//Runs the first due task, if any
+void sched_runOnce(void) {
+    unsigned char i;
+    unsigned long start;
+    unsigned long elapsed;
+
+    for (i=0; i<sched_count; i++) {
+        if (!sched_pending[i]) continue;
+        sched_pending[i] = 0;
+
+        start = sched_clock();
+        sched_fn[i]();
+        elapsed = sched_clock() - start;
+        if (elapsed > 0xFFFF) elapsed = 0xFFFF;
+
+        sched_runs[i]++;
+        sched_totalRun[i] += elapsed;
+        if (elapsed > sched_maxRun[i]) sched_maxRun[i] = (unsigned int)elapsed;
+        return;
+    }
+}
+
+void sched_run(void) {
+    while(1) {
+        sched_runOnce();
+    }
+}
+
+//Two profile frames per task, its worst and its mean run time since the
+//last report
+void sched_report(void) {
+    unsigned char i;
+
+    for (i=0; i<sched_count; i++) {
+        tlm_sendProfile(i, sched_maxRun[i]);
+        if (sched_runs[i]) tlm_sendProfile(SCHED_PROFILE_MEAN + i, sched_totalRun[i] / sched_runs[i]);
+        sched_maxRun[i] = 0;
+        sched_totalRun[i] = 0;
+        sched_runs[i] = 0;
+    }
+}
@@ -0,0 +1,30 @@
+// Cooperative scheduler ticked from the Timer0 overflow (one tick = 4.096ms).
+// Tasks run to completion from sched_run() in table order, so a task added
+// earlier wins when several are due at once. Interrupt handlers wake tasks
+// with sched_signal(); nothing else in the scheduler is touched from an ISR.
+
+#define SCHED_MAX_TASKS     8
+#define SCHED_NONE          0xFF
+#define SCHED_TICK_US       4096
+#define SCHED_PROFILE_MEAN  0x40    // tlm_sendProfile id + task for the mean run time
+
+//Milliseconds to ticks, rounded up (constant folded)
+#define SCHED_MS(ms)        ((unsigned int)(((unsigned long)(ms)*1000 + SCHED_TICK_US - 1) / SCHED_TICK_US))
+
+typedef void (*sched_task)(void);
+
+extern volatile unsigned int sched_ticks;
+
+void sched_init(void);
+unsigned char sched_addPeriodic(sched_task fn, unsigned int period);
+unsigned char sched_addOneShot(sched_task fn, unsigned int delay);
+unsigned char sched_addEvent(sched_task fn);
+void sched_delay(unsigned char id, unsigned int delay);
+void sched_signal(unsigned char id);
+
+void sched_tick(void);
+unsigned long sched_clock(void);
+void sched_runOnce(void);
+void sched_run(void);
+
+void sched_report(void);
@@ -5,12 +5,24 @@
 #include "config.h"
 #include "serlcd.h"
 #include "nRF2401.h"
+#include "telemetry.h"
+#include "nrf_shadow.h"
+#include "nrf_boot.h"
+#include "pot.h"
+#include "sched.h"
+#include "sniffer.h"
+#include "strip.h"
+#include "txqueue.h"
+#include "eeprom.h"
+#include "pattern.h"
+#include "linkstore.h"
+#include "bootloader.h"
 
 
     //a1 //red
     //a2 //green
     //a3 //yellow
-    //b3 //eeprom
+    //b3 //eeprom (eeprom.h)
 #define LED_RED_TRIS      TRISAbits.TRISA0
 #define LED_RED           PORTAbits.RA0
 
@@ -20,9 +32,6 @@
 #define LED_YELLOW_TRIS   TRISAbits.TRISA2
 #define LED_YELLOW        PORTAbits.RA2
 
-#define EEPROM_CS_TRIS    TRISBbits.TRISB3
-#define EEPROM_CS         PORTBbits.RB3
-
 #define LED_ON            0
 #define LED_OFF           1
 
@@ -39,9 +48,6 @@ void setup(void);
 void run(void);
 void interruptService(void);
 
-////                            Shared Code                                 ////
-void delay(void);
-
 ////                            System Code                                 ////
 void main(void);
 void interrupt interrupt_high(void);
@@ -52,7 +58,6 @@ void setup(void) {
     LED_RED_TRIS = OUTPUT;
     LED_GREEN_TRIS = OUTPUT;
     LED_YELLOW_TRIS = OUTPUT;
-    EEPROM_CS_TRIS = OUTPUT;
     STRIP_TRIS = OUTPUT;
 
 
@@ -108,13 +113,13 @@ void setup(void) {
     BAUDCON1bits.BRG16 = 0;
     TXSTA1bits.BRGH = 1;
 
-    // 19.2kbaud = 001, 832
+    // 64MHz / (16 * (34 + 1)) = 114.3kbaud, 0.8% off the host side 115200
     SPBRG1 = 34;
     
     //9.6kbaud = 000, 103
     RCSTA1bits.CREN = SET;
 
-    EEPROM_CS = 1;
+    ee_init();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -122,28 +127,272 @@ void setup(void) {
 ////                            Sender Code                                 ////
 ////                                                                        ////
 ////////////////////////////////////////////////////////////////////////////////
-void dumpNrf(void) {
-    int i;
-    char val;
-    for (int i=0; i<=0x1d; i++) {
-        val = nrf_readRegister(i);
-        sendHex(i);
-        sendLiteralBytes("\t");
-        sendHex(val);
-        sendLiteralBytes("\n");
+#define REPORT_PERIOD   SCHED_MS(1000)
+
+unsigned char sendTaskId = SCHED_NONE;
+
+void reportTask(void) {
+    tlm_flushStatus();
+    sched_report();
+}
+
+//Forwarded pattern write waiting for the receiver's answer
+unsigned char writeTag = 0;
+unsigned char writePending = 0;
+unsigned char writeAddr[2];
+
+void hostWriteAck(unsigned char * addr, unsigned char status) {
+    unsigned char msg[3];
+
+    msg[0] = addr[0];
+    msg[1] = addr[1];
+    msg[2] = status;
+    tlm_sendFrame(TLM_EEACK, msg, 3);
+}
+
+unsigned char radioSend(unsigned char * buf) {
+    unsigned char result;
+
+    LED_RED++;
+    result = nrf_send(buf, rx_buf);
+    LED_GREEN = !result;
+    tlm_noteStatus(nrf_getStatus(), result);
+
+    //any later packet to the receiver brings the answer back
+    if (result && writePending && rx_buf[0] == PAT_MSG_STATUS && rx_buf[1] == writeTag) {
+        writePending = 0;
+        hostWriteAck(writeAddr, rx_buf[2]);
     }
+    return result;
 }
 
-void run(void) {
-    int i;
-    short nextSlot;
-    char status;
+unsigned char bridge = 0;       // sender only: host frames may go out over RF
+
+//TLM_EEWRITE from the host: queue the chunk for the pattern EEPROM and, if
+//asked, for the receivers too. A forwarded chunk is only acked once the
+//receiver's answer is back (see radioSend); without one the host times out.
+//The host resends on anything but TLM_EE_OK.
+void hostWrite(void) {
+    unsigned char msg[MAX_PAYLOAD];
+    unsigned char len = tlm_rxLen - 3;
+    unsigned char forward;
+    unsigned char status;
+    unsigned char i;
+
+    if (tlm_rxLen < 4) return;
+    forward = bridge && (tlm_rx[0] & PAT_FORWARD);
+
+    if (len > PAT_WRITE_MAX || (forward && len > MAX_PAYLOAD - 4)) {
+        status = TLM_EE_LENGTH;
+    } else if (!pat_write(tlm_rx[1] | (unsigned int)tlm_rx[2] << 8, tlm_rx + 3, len)) {
+        status = TLM_EE_BUSY;
+    } else if (forward) {
+        msg[0] = PAT_MSG_WRITE;
+        msg[1] = ++writeTag;
+        for (i=1; i<tlm_rxLen; i++) {
+            msg[i+1] = tlm_rx[i];
+        }
+        writePending = txq_put(TXQ_CONTROL, msg, len + 4);
+        writeAddr[0] = tlm_rx[1];
+        writeAddr[1] = tlm_rx[2];
+        sched_signal(sendTaskId);
+        if (writePending) return;
+        status = TLM_EE_BUSY;
+    } else {
+        status = TLM_EE_OK;
+    }
+
+    hostWriteAck(tlm_rx + 1, status);
+}
+
+//TLM_OTA: one loader command from tools/otaflash, sent straight away
+//(outside the queue). The answer carries the bootloader's ACK payload.
+void hostOta(void) {
+    unsigned char msg[MAX_PAYLOAD];
+    unsigned char answer[1 + BL_ACK_LEN];
+    unsigned char len = 0;
+    unsigned char i;
 
-    nrf_init();
-    delay();
+    if (tlm_rxLen < 2 || tlm_rxLen > MAX_PAYLOAD + 1) return;
 
-    nrf_rxmode();
-    delay();
+    for (i=0; i<MAX_PAYLOAD; i++) {
+        msg[i] = (i + 1 < tlm_rxLen) ? tlm_rx[i + 1] : 0xFF;
+    }
+
+    nrfs_setTxAddr(tlm_rx[0]);
+    answer[0] = radioSend(msg);
+    nrfs_setTxAddr(NRF_DEFAULT_ID);
+
+    //nrf_send() left the ACK payload in rx_buf
+    if (answer[0]) {
+        for (len=0; len<BL_ACK_LEN; len++) {
+            answer[1 + len] = rx_buf[len];
+        }
+    }
+    tlm_sendFrame(TLM_OTAACK, answer, 1 + len);
+}
+
+#define OTA_INFLIGHT    3               // TX FIFO depth
+#define OTA_LINGER      SCHED_MS(20)    // no new data this long ends a stream
+
+#ifndef TX_EMPTY
+#define TX_EMPTY        0x10            // FIFO_STATUS
+#endif
+
+unsigned char otaAck[BL_ACK_LEN];       // latest ACK payload from the loader
+unsigned char otaAckLen;
+
+void otaAnswer(unsigned char result) {
+    unsigned char answer[1 + BL_ACK_LEN];
+    unsigned char i;
+
+    answer[0] = result;
+    for (i=0; i<otaAckLen; i++) {
+        answer[1 + i] = otaAck[i];
+    }
+    tlm_sendFrame(TLM_OTAACK, answer, 1 + otaAckLen);
+}
+
+void hostFrame(unsigned char type);
+
+//TLM_OTADATA: image payloads from tools/otaflash, streamed. Up to
+//OTA_INFLIGHT of them wait in the TX FIFO and go out back to back while CE
+//stays high. Each is answered with a TLM_OTAACK once the radio is done with
+//it (TX_DS, or MAX_RT for it and everything queued behind it), carrying the
+//latest ACK payload the loader sent. More TLM_OTADATA frames are taken as
+//they come in; the stream ends OTA_LINGER after the last one, or once the
+//FIFO has drained behind any other host frame, which is then handled.
+void hostStream(void) {
+    unsigned char inFlight = 0;
+    unsigned char type = TLM_OTADATA;
+    unsigned char other = 0;
+    unsigned char status;
+    unsigned char len;
+    unsigned char i;
+    unsigned long last = sched_clock();
+
+    nrfs_setTxAddr(tlm_rx[0]);
+    nrf_SPI_RW_Reg(FLUSH_TX, 0);
+    nrf_SPI_RW_Reg(FLUSH_RX, 0);
+    nrfs_write(STATUS, RX_DR | TX_DS | MAX_RT);
+    otaAckLen = 0;
+
+    while (1) {
+        if (type == TLM_OTADATA) {
+            if (tlm_rxLen < 4 || tlm_rxLen > MAX_PAYLOAD + 1) {
+                otaAnswer(0);
+            } else {
+                nrf_SPI_Write_Buf(WR_TX_PLOAD, tlm_rx + 1, tlm_rxLen - 1);
+                inFlight++;
+                CE = SET;
+            }
+            last = sched_clock();
+        } else if (type) {
+            other = type;
+        }
+
+        status = nrf_getStatus();
+        if (status & RX_DR) {
+            len = nrf_SPI_Read(R_RX_PL_WID);
+            if (len == 0 || len > MAX_PAYLOAD) {
+                nrf_SPI_RW_Reg(FLUSH_RX, 0);
+            } else {
+                nrf_SPI_Read_Buf(RD_RX_PLOAD, rx_buf, len);
+                otaAckLen = (len < BL_ACK_LEN) ? len : BL_ACK_LEN;
+                for (i=0; i<otaAckLen; i++) {
+                    otaAck[i] = rx_buf[i];
+                }
+            }
+            nrfs_write(STATUS, RX_DR);
+        }
+        if ((status & TX_DS) && inFlight) {
+            nrfs_write(STATUS, TX_DS);
+            inFlight--;
+            otaAnswer(1);
+        }
+        if (status & MAX_RT) {
+            //the loader drops whatever follows a lost payload anyway
+            nrf_SPI_RW_Reg(FLUSH_TX, 0);
+            nrfs_write(STATUS, MAX_RT);
+            while (inFlight) {
+                inFlight--;
+                otaAnswer(0);
+            }
+        } else if (inFlight && (nrfs_read(FIFO_STATUS) & TX_EMPTY)
+                && !(nrf_getStatus() & (TX_DS | MAX_RT))) {
+            //two sends finished between polls and share one TX_DS
+            while (inFlight) {
+                inFlight--;
+                otaAnswer(1);
+            }
+        }
+
+        if (!inFlight && (other || sched_clock() - last > (unsigned long)OTA_LINGER << 16)) break;
+
+        type = 0;
+        if (!other && inFlight < OTA_INFLIGHT) type = tlm_poll();
+    }
+
+    CE = CLEAR;
+    nrf_SPI_RW_Reg(FLUSH_RX, 0);
+    nrfs_setTxAddr(NRF_DEFAULT_ID);
+    sched_signal(sendTaskId);
+
+    if (other) hostFrame(other);
+}
+
+void hostFrame(unsigned char type) {
+    switch (type) {
+        case TLM_EEWRITE:
+            hostWrite();
+            break;
+        case TLM_OTA:
+            if (bridge) hostOta();
+            break;
+        case TLM_OTADATA:
+            if (bridge) hostStream();
+            break;
+    }
+}
+
+//Receiver is the sniffer: every payload goes out as a TLM_TRACE frame
+void receiveTask(void) {
+    char status;
+    unsigned char pipe;
+    unsigned char len;
+    unsigned char count;
+
+    LED_RED++;
+    status = nrf_getStatus();
+
+    count = 0;
+    while ((len = sniff_next(rx_buf, &pipe)) != 0) {
+        count++;
+
+        //replayed traffic is traced, never acted on
+        if (pipe & SNIFF_INJECTED) continue;
+
+        //pattern chunks forwarded by a sender; the outcome goes back in
+        //every ACK payload from here on, until the next write
+        if (rx_buf[0] == PAT_MSG_WRITE && len > 4) {
+            sniff_ackData[0] = PAT_MSG_STATUS;
+            sniff_ackData[1] = rx_buf[1];
+            sniff_ackData[2] = pat_write(rx_buf[2] | (unsigned int)rx_buf[3] << 8, rx_buf + 4, len - 4)
+                             ? TLM_EE_OK : TLM_EE_BUSY;
+            sniff_ackLen = 3;
+        }
+        //tools/otaflash -r, for this board only
+        if (rx_buf[0] == BL_MSG_REQUEST && len >= 4 && rx_buf[1] == 'B' && rx_buf[2] == 'L'
+                && rx_buf[3] == lstore_boardId()) {
+            lstore_bootRequest();
+        }
+    }
+    LED_GREEN = !count;
+    tlm_noteStatus(status, count != 0);
+}
+
+void run(void) {
+    nrf_bootRx();
 
     LED_YELLOW = LED_ON;
 
@@ -152,55 +401,134 @@ void run(void) {
 
     sendLiteralBytes("Receiver!\n");
 
-    dumpNrf();
+    tlm_sendRegisters();
 
-    i=0;
-    while(1) {
-        LED_RED++;
-        sendIntDec(nrf_getStatus());
-        sendLiteralBytes("\n");
+    sniff_init(1);
+    sniff_host = hostFrame;
+    pat_init();
 
-        LED_GREEN = !nrf_receive(&tx_buf,&rx_buf);
-        delay();
+    sched_init();
+    sched_addPeriodic(receiveTask, 1);
+    sched_addPeriodic(pat_task, 1);
+    sched_addPeriodic(reportTask, REPORT_PERIOD);
+    sched_run();
+}
+
+#define FRAME_PERIOD    SCHED_MS(40)
+#define BEACON_PERIOD   SCHED_MS(1000)
+#define ANIM_RUN        16      // LEDs per run in the animation frames
+#define ANIM_RUNS       ((STRIP_LEDS + ANIM_RUN - 1) / ANIM_RUN)
+#define MSG_BEACON      0x54    // sent/dropped per queue class
+
+unsigned char animOffset = 0;
+
+//Slice n of the current frame: the gradient scrolled by animOffset, ANIM_RUN
+//LEDs per colour, STRIP_RUNS_PER_MSG runs per payload
+unsigned char animSlice(unsigned char n, unsigned char * buf) {
+    unsigned char first = n * STRIP_RUNS_PER_MSG;
+    unsigned char count;
+    unsigned char i;
+    unsigned int src;
+
+    if (first >= ANIM_RUNS) return 0;
+    count = ANIM_RUNS - first;
+    if (count > STRIP_RUNS_PER_MSG) count = STRIP_RUNS_PER_MSG;
+
+    buf[0] = STRIP_MSG_RUNS;
+    buf[1] = first;
+    buf[2] = count;
+    for (i=0; i<count; i++) {
+        src = (unsigned int)((first + i) * 4 + animOffset) % STRIP_SOURCE_LEDS * 3;
+        buf[3 + i*4] = ANIM_RUN;
+        buf[4 + i*4] = strip_gradient[src];
+        buf[5 + i*4] = strip_gradient[src+1];
+        buf[6 + i*4] = strip_gradient[src+2];
     }
+    return 3 + count*4;
 }
 
-void runSend(void) {
-    nrf_init();
-    delay();
+//Event task: woken by anything that queues. Sends one packet per run so a
+//control payload never waits behind a whole frame.
+void sendTask(void) {
+    if (txq_service()) sched_signal(sendTaskId);
+}
 
-    nrf_txmode();
-    delay();
+//Stored patterns take over from the built in gradient once one is loaded.
+//The gradient scrolls on its own, and moving the pot sets where it is.
+void frameTask(void) {
+    if (pat_count) {
+        //the frame is read from the EEPROM slice by slice as it goes out
+        if (!ee_busy()) {
+            pat_next();
+            txq_bulk(pat_slice);
+        }
+    } else {
+        if (pot_ready()) {
+            animOffset = pot_read() >> 7;
+            if (animOffset > STRIP_SOURCE_LEDS - 1) animOffset = STRIP_SOURCE_LEDS - 1;
+        } else if (++animOffset >= STRIP_SOURCE_LEDS) {
+            animOffset = 0;
+        }
+        txq_bulk(animSlice);
+    }
+    sched_signal(sendTaskId);
+}
 
-    //nrf_setTxAddr(0);
-    //nrf_setRxAddr(0,0);
+void hostTask(void) {
+    unsigned char type = tlm_poll();
 
-    sendLiteralBytes("Sender!\n");
+    if (type) hostFrame(type);
+}
 
-    dumpNrf();
+void beaconTask(void) {
+    unsigned char msg[1 + TXQ_CLASSES*2];
+    unsigned char i;
 
-    tx_buf[0] = 42;
-    while(1) {
-        LED_RED++;
-        LED_GREEN = !nrf_send(&tx_buf,&rx_buf);
-        sendIntDec(nrf_getStatus());
-        sendLiteralBytes("\n");
-        delay();
+    msg[0] = MSG_BEACON;
+    for (i=0; i<TXQ_CLASSES; i++) {
+        msg[1 + i*2] = txq_sent[i];
+        msg[2 + i*2] = txq_dropped[i];
     }
+    txq_put(TXQ_TELEMETRY, msg, sizeof(msg));
+    sched_signal(sendTaskId);
 }
 
-void interruptService(void) {
+void reportSend(void) {
+    txq_report();
+    reportTask();
+}
+
+void runSend(void) {
+    nrf_bootTx();
+
+    //nrf_setTxAddr(0);
+    //nrf_setRxAddr(0,0);
 
+    sendLiteralBytes("Sender!\n");
+
+    tlm_sendRegisters();
+
+    pot_init();
+    txq_init(radioSend);
+    tlm_rxInit();
+    pat_init();
+    bridge = 1;
+
+    sched_init();
+    sendTaskId = sched_addEvent(sendTask);
+    sched_addPeriodic(hostTask, 1);
+    sched_addPeriodic(pat_task, 1);
+    sched_addPeriodic(frameTask, FRAME_PERIOD);
+    sched_addPeriodic(beaconTask, BEACON_PERIOD);
+    sched_addPeriodic(reportSend, REPORT_PERIOD);
+    sched_run();
 }
 
-////////////////////////////////////////////////////////////////////////////////
-////                                                                        ////
-////                            Shared Code                                 ////
-////                                                                        ////
-////////////////////////////////////////////////////////////////////////////////
+void interruptService(void) {
+    tlm_rxService();
+    pot_service();
 
-void delay(void) {
-    Delay10KTCYx(254);
+    if (INTCONbits.TMR0IF) pot_tick();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,12 +541,18 @@ void delay(void) {
 void main(void) {
     setup();
 
+#ifdef RELAY_SNIFFER
+    run();
+#else
     runSend();
+#endif
 
     while(1);
 }
 
 void interrupt interrupt_high(void) {
+    if (INTCONbits.TMR0IF) sched_tick();
+
     interruptService();
 
     INTCONbits.TMR0IF = CLEAR;
@@ -0,0 +1,207 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "nrf_shadow.h"
+#include "telemetry.h"
+#include "sched.h"
+#include "tick.h"
+#include "sniffer.h"
+
+unsigned char sniff_capture = 0;
+unsigned char sniff_overrun = 0;
+sniff_handler sniff_host = 0;
+
+unsigned char sniff_ackData[SNIFF_ACK_MAX] = {0};
+unsigned char sniff_ackLen = 1;
+
+//Pipe masks. The TX FIFO holds SNIFF_ACK_DEPTH ACK payloads and the radio
+//never says which pipes they are for, so keep count here.
+unsigned char sniff_ackQueued = 0;  //have an ACK payload in the TX FIFO
+unsigned char sniff_ackKept = 0;    //...that a handler queued, can't be written again
+unsigned char sniff_ackOwed = 0;    //waiting for the default ACK payload
+unsigned char sniff_ackCount = 0;
+unsigned char sniff_ackPipe = SNIFF_PIPE_EMPTY;    //last pipe read, goes first
+
+void sniff_init(unsigned char capture) {
+    sniff_capture = capture;
+    sniff_ackFlush();
+    sniff_overrun = tlm_rxOverrun;
+    tlm_rxInit();
+}
+
+//Scheduler tick count in the top half, Timer0 in the bottom half. Read
+//again if the overflow interrupt got in between.
+unsigned long sniff_timestamp(void) {
+    unsigned int hi;
+    unsigned int lo;
+
+    do {
+        hi = sched_ticks;
+        lo = tick_now();
+    } while (hi != sched_ticks);
+
+    return ((unsigned long)hi << 16) | lo;
+}
+
+void sniff_putStamp(void) {
+    unsigned long now = sniff_timestamp();
+
+    tlm_put(now & 0xFF);
+    tlm_put((now >> 8) & 0xFF);
+    tlm_put((now >> 16) & 0xFF);
+    tlm_put(now >> 24);
+}
+
+//Inject overruns are always reported, replays normally run with capture off
+void sniff_loss(unsigned char reason) {
+    if (!sniff_capture && reason != TLM_LOSS_INJECT) return;
+
+    tlm_begin(TLM_LOSS, 5);
+    sniff_putStamp();
+    tlm_put(reason);
+    tlm_end();
+}
+
+void sniff_trace(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    unsigned char i;
+
+    tlm_begin(TLM_TRACE, TLM_TRACE_HEADER + len);
+    sniff_putStamp();
+    tlm_put(pipe);
+    for (i=0; i<len; i++) {
+        tlm_put(buf[i]);
+    }
+    tlm_end();
+}
+
+//Empties the TX FIFO; defaults that were in it are owed again
+void sniff_ackFlush(void) {
+    nrf_SPI_RW_Reg(FLUSH_TX, 0);
+    sniff_ackOwed |= sniff_ackQueued & ~sniff_ackKept;
+    sniff_ackQueued = 0;
+    sniff_ackKept = 0;
+    sniff_ackCount = 0;
+}
+
+void sniff_ackWrite(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    nrf_SPI_Write_Buf(W_ACK_PAYLOAD | pipe, buf, len);
+    sniff_ackQueued |= 1 << pipe;
+    sniff_ackOwed &= ~(1 << pipe);
+    sniff_ackCount++;
+}
+
+//Makes room for one ACK payload on pipe. There is no taking a single payload
+//back out, so a full FIFO (or one already holding pipe) is only flushed while
+//everything in it is a default that can be written again.
+unsigned char sniff_ackRoom(unsigned char pipe) {
+    if (!(sniff_ackQueued & (1 << pipe)) && sniff_ackCount < SNIFF_ACK_DEPTH) return 1;
+    if (sniff_ackKept) return 0;
+
+    sniff_ackFlush();
+    return 1;
+}
+
+//Defaults for the owed pipes while there is room, the last pipe read first
+void sniff_ackFill(void) {
+    unsigned char pipe;
+
+    if (!(nrfs_read(CONFIG) & PRIM_RX)) return;
+
+    if (sniff_ackPipe != SNIFF_PIPE_EMPTY && (sniff_ackOwed & (1 << sniff_ackPipe))
+            && sniff_ackRoom(sniff_ackPipe)) {
+        sniff_ackWrite(sniff_ackPipe, sniff_ackData, sniff_ackLen);
+    }
+    for (pipe=0; pipe<6 && sniff_ackCount < SNIFF_ACK_DEPTH; pipe++) {
+        if (sniff_ackOwed & (1 << pipe)) sniff_ackWrite(pipe, sniff_ackData, sniff_ackLen);
+    }
+}
+
+//Queues the ACK payload for the next payload on pipe in place of the default.
+//Only a receiver has ACK payloads to give, and host payloads never see an ACK.
+//Dropped if the FIFO is full of other handlers' payloads.
+void sniff_ack(unsigned char pipe, unsigned char * buf, unsigned char len) {
+    if ((pipe & SNIFF_INJECTED) || !(nrfs_read(CONFIG) & PRIM_RX)) return;
+    if (!sniff_ackRoom(pipe)) return;
+
+    sniff_ackWrite(pipe, buf, len);
+    sniff_ackKept |= 1 << pipe;
+    sniff_ackFill();
+}
+
+//Next payload from the RX FIFO, returns its length (0 if the FIFO is empty).
+//The pipe of the payload before gets the default ACK payload unless its
+//handler queued one.
+//
+//A payload that found no ACK payload queued for its pipe was acked bare. Its
+//sender counts it as lost and sends it again, so it is dropped here rather
+//than handled twice.
+unsigned char sniff_read(unsigned char * buf, unsigned char * pipe) {
+    unsigned char len;
+    unsigned char mask;
+
+    do {
+        sniff_ackFill();
+
+        *pipe = (nrf_getStatus() >> 1) & 0x07;
+        if (*pipe == SNIFF_PIPE_EMPTY) return 0;
+
+        //A full FIFO means anything that arrived since was not received
+        if (nrfs_read(FIFO_STATUS) & RX_FULL) sniff_loss(TLM_LOSS_FIFO_FULL);
+
+        len = nrf_SPI_Read(R_RX_PL_WID);
+        if (len == 0 || len > MAX_PAYLOAD) {
+            nrf_SPI_RW_Reg(FLUSH_RX, 0);
+            nrfs_write(STATUS, RX_DR);
+            sniff_loss(TLM_LOSS_LENGTH);
+            return 0;
+        }
+
+        nrf_SPI_Read_Buf(RD_RX_PLOAD, buf, len);
+        nrfs_write(STATUS, RX_DR);
+
+        //its ACK payload went out with it
+        mask = 1 << *pipe;
+        sniff_ackPipe = *pipe;
+        sniff_ackOwed |= mask;
+        if (sniff_ackQueued & mask) {
+            sniff_ackQueued &= ~mask;
+            sniff_ackKept &= ~mask;
+            sniff_ackCount--;
+            mask = 0;
+        }
+    } while (mask);
+
+    if (sniff_capture) sniff_trace(*pipe, buf, len);
+    return len;
+}
+
+//Host frames first so a replay is not starved by live traffic
+unsigned char sniff_next(unsigned char * buf, unsigned char * pipe) {
+    unsigned char type;
+    unsigned char i;
+
+    if (sniff_overrun != tlm_rxOverrun) {
+        sniff_overrun = tlm_rxOverrun;
+        sniff_loss(TLM_LOSS_INJECT);
+    }
+
+    switch (type = tlm_poll()) {
+        case 0:
+            break;
+        case TLM_INJECT:
+            if (tlm_rxLen < 2 || tlm_rxLen > MAX_PAYLOAD + 1) break;
+            *pipe = tlm_rx[0] | SNIFF_INJECTED;
+            for (i=1; i<tlm_rxLen; i++) {
+                buf[i-1] = tlm_rx[i];
+            }
+            return tlm_rxLen - 1;
+        case TLM_CAPTURE:
+            if (tlm_rxLen) sniff_capture = tlm_rx[0];
+            break;
+        default:
+            if (sniff_host) sniff_host(type);
+            break;
+    }
+
+    return sniff_read(buf, pipe);
+}
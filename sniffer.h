@@ -0,0 +1,51 @@
+// Receive path shared by the receiver roles. sniff_next() hands out the next
+// payload with its pipe and length, either drained from the RX FIFO or
+// injected by the host (tools/tracereplay), so replayed traffic goes through
+// exactly the same handler as live traffic. With capture on, every radio
+// payload is also streamed as a TLM_TRACE frame and a TLM_LOSS marker goes
+// out whenever the radio may have dropped something.
+//
+// Senders only count a payload as delivered when an ACK payload comes back,
+// so every payload read from a pipe gets the next one queued on that pipe:
+// sniff_ackData by default, or whatever the handler passed to sniff_ack().
+// The TX FIFO only takes SNIFF_ACK_DEPTH of them, so with more pipes active
+// than that the quiet ones wait; a payload that came in without one is
+// dropped and left to its sender to resend.
+
+#define SNIFF_PIPE_EMPTY    0x07    // RX_P_NO when the RX FIFO is empty
+#define SNIFF_INJECTED      0x80    // or'ed into the pipe of host payloads
+
+#ifndef RX_FULL
+#define RX_FULL             0x02    // FIFO_STATUS
+#endif
+
+#ifndef R_RX_PL_WID
+#define R_RX_PL_WID         0x60
+#endif
+
+#ifndef TX_FULL
+#define TX_FULL             0x20    // FIFO_STATUS
+#endif
+
+#define SNIFF_ACK_MAX       4
+#define SNIFF_ACK_DEPTH     3       // TX FIFO entries
+
+//Called from sniff_next() with any other host frame type; the payload is
+//still in tlm_rx
+typedef void (*sniff_handler)(unsigned char type);
+
+extern unsigned char sniff_capture;
+extern sniff_handler sniff_host;
+extern unsigned char sniff_ackData[SNIFF_ACK_MAX];
+extern unsigned char sniff_ackLen;
+
+void sniff_init(unsigned char capture);
+unsigned long sniff_timestamp(void);
+void sniff_loss(unsigned char reason);
+void sniff_trace(unsigned char pipe, unsigned char * buf, unsigned char len);
+
+void sniff_ackFlush(void);
+void sniff_ackFill(void);
+void sniff_ack(unsigned char pipe, unsigned char * buf, unsigned char len);
+unsigned char sniff_read(unsigned char * buf, unsigned char * pipe);
+unsigned char sniff_next(unsigned char * buf, unsigned char * pipe);
@@ -0,0 +1,221 @@
+#include <xc.h>
+#include "constants.h"
+#include "tick.h"
+#include "sched.h"
+#include "telemetry.h"
+#include "strip.h"
+
+//The old source[] gradient, tiled along the strip
+const unsigned char strip_gradient[STRIP_SOURCE_LEDS*3] = {
+    0,15,0,0,15,0,1,15,0,2,15,0,3,15,0,3,15,0,4,15,0,5,15,0,
+    6,15,0,6,15,0,7,15,0,8,15,0,9,15,0,9,15,0,10,15,0,11,15,0,
+    12,15,0,13,15,0,13,15,0,14,15,0,15,15,0,15,15,0,15,15,0,15,14,0,
+    15,13,0,15,12,0,15,11,0,15,11,0,15,10,0,15,9,0,15,8,0,15,8,0,
+    15,7,0,15,6,0,15,5,0,15,5,0,15,4,0,15,3,0,15,2,0,15,2,0,
+    15,1,0,15,0,0,15,0,0,15,0,1,15,0,1,15,0,2,15,0,3,15,0,4,
+    15,0,4,15,0,5,15,0,6,15,0,7,15,0,7,15,0,8,15,0,9,15,0,10,
+    15,0,10,15,0,11,15,0,12,15,0,13,15,0,14,15,0,14,15,0,15,15,0,15,
+    14,0,15,14,0,15,13,0,15,12,0,15,11,0,15,10,0,15,10,0,15,9,0,15,
+    8,0,15,7,0,15,7,0,15,6,0,15,5,0,15,4,0,15,4,0,15,3,0,15,
+    2,0,15,1,0,15,1,0,15,0,0,15,0,0,15,0,1,15,0,2,15,0,2,15,
+    0,3,15,0,4,15,0,5,15,0,5,15,0,6,15,0,7,15,0,8,15,0,8,15,
+    0,9,15,0,10,15,0,11,15,0,11,15,0,12,15,0,13,15,0,14,15,0,15,15,
+    0,15,15,0,15,15,0,15,14,0,15,13,0,15,13,0,15,12,0,15,11,0,15,10,
+    0,15,9,0,15,9,0,15,8,0,15,7,0,15,6,0,15,6,0,15,5,0,15,4,
+    0,15,3,0,15,3,0,15,2,0,15,1,0,15,0
+};
+
+unsigned char strip_window[2][STRIP_SLICE*3];
+
+//Read by led.asm
+unsigned char * strip_ptr;
+unsigned char strip_count;
+
+//Table row (address high byte) per channel in output order G, R, B, with G
+//repeated for the byte led.asm fetches ahead at the end of each LED
+unsigned char strip_lutRow[4];
+unsigned char strip_correction[3] = {0, 0, 0};
+
+unsigned char strip_offset = 0;
+unsigned int strip_gapMax = 0;
+
+//Run length coded frame: count, g, r, b per run; LEDs past the last run are off
+unsigned char strip_runs[STRIP_RUNS*4];
+unsigned char strip_runCount = 0;
+
+//Where the last generator call stopped, so a call that carries on from there
+//costs the same as any other (no modulo, no run search)
+unsigned int strip_genNext = 0xFFFF;
+unsigned int strip_gradIndex;
+unsigned char strip_runIndex;
+unsigned char strip_runLeft;
+
+void strip_init(void) {
+    LATAbits.LATA0 = 0;
+    strip_runCount = 0;
+    strip_gapMax = 0;
+    strip_setLevel(STRIP_LUT_RAW);
+}
+
+//Level 0-15, or STRIP_LUT_RAW to send values untouched. Levels are linear,
+//so correction scales a channel by (256 - correction)/256 by picking a lower
+//level for it.
+void strip_setLevel(unsigned char level) {
+    unsigned char c;
+    unsigned char l;
+
+    for (c=0; c<3; c++) {
+        l = level;
+        if (level != STRIP_LUT_RAW) {
+            l = ((unsigned int)level * (256 - strip_correction[c]) + 128) >> 8;
+        }
+        strip_lutRow[c] = (STRIP_LUT_ADDR >> 8) + l;
+    }
+    strip_lutRow[3] = strip_lutRow[0];
+}
+
+//Interrupts are off for the whole frame (~17ms). The UART is polled in the
+//gaps instead, and the Timer0 overflows the ISR can't see (it only gets the
+//last one) are handed to the scheduler at the end.
+void strip_render(strip_generator gen) {
+    unsigned char saveGIE = INTCONbits.GIE;
+    unsigned char pending;
+    unsigned char * out = strip_window[0];
+    unsigned char * next = strip_window[1];
+    unsigned char * swap;
+    unsigned int first = 0;     //first LED of the window going out
+    unsigned int ahead;         //next LED to generate
+    unsigned char n = STRIP_SLICE;
+    unsigned char sent;
+    unsigned char k;
+    unsigned int start;
+    unsigned int last;
+    unsigned int now;
+    unsigned int gap;
+    unsigned long elapsed = 0;
+    unsigned char wraps;
+
+    INTCONbits.GIE = 0;
+    pending = INTCONbits.TMR0IF;
+
+    //the line is idle before the first bit, so this one can take its time
+    gen(0, n, out);
+    ahead = n;
+
+    PIR1bits.TMR2IF = 1;    //first bit goes out without waiting for Timer2
+    start = tick_now();
+    last = start;
+
+    while (1) {
+        for (sent=0; sent<n; sent+=STRIP_STEP) {
+            strip_ptr = out + sent*3;
+            strip_count = (n - sent < STRIP_STEP) ? n - sent : STRIP_STEP;
+            strip_sendWindow();
+
+            now = tick_now();
+            elapsed += (unsigned int)(now - last);
+            last = now;
+
+            if (ahead < STRIP_LEDS) {
+                k = (STRIP_LEDS - ahead < STRIP_STEP) ? STRIP_LEDS - ahead : STRIP_STEP;
+                gen(ahead, k, next + (ahead - first - n)*3);
+                ahead += k;
+            }
+            //the receiver holds two bytes, both may be in by now
+            while (PIR1bits.RC1IF) tlm_rxService();
+
+            now = tick_now();
+            gap = now - last;
+            elapsed += gap;
+            last = now;
+            if (gap > strip_gapMax) strip_gapMax = gap;
+        }
+
+        first += n;
+        if (first >= STRIP_LEDS) break;
+        n = ahead - first;
+
+        swap = out;
+        out = next;
+        next = swap;
+    }
+
+    elapsed += (unsigned int)(tick_now() - last);
+
+    wraps = (elapsed + start) >> 16;
+    if (wraps && !pending) wraps--;     //still flagged for the ISR
+    while (wraps--) sched_tick();
+
+    INTCONbits.GIE = saveGIE;
+}
+
+//Straight table copy with one wrap check per LED
+void strip_genGradient(unsigned int first, unsigned char count, unsigned char * out) {
+    unsigned int i = strip_gradIndex;
+
+    if (first != strip_genNext || first == 0) i = (first + strip_offset) % STRIP_SOURCE_LEDS * 3;
+    strip_genNext = first + count;
+
+    while (count--) {
+        *out++ = strip_gradient[i];
+        *out++ = strip_gradient[i+1];
+        *out++ = strip_gradient[i+2];
+        i += 3;
+        if (i >= STRIP_SOURCE_LEDS*3) i = 0;
+    }
+    strip_gradIndex = i;
+}
+
+void strip_genRuns(unsigned int first, unsigned char count, unsigned char * out) {
+    unsigned char r = strip_runIndex;
+    unsigned char left = strip_runLeft;
+
+    //find the run holding LED first, unless carrying on from the last call
+    if (first != strip_genNext || first == 0) {
+        strip_genNext = first;
+        r = 0;
+        while (r < strip_runCount && first >= strip_runs[r*4]) {
+            first -= strip_runs[r*4];
+            r++;
+        }
+        left = (r < strip_runCount) ? strip_runs[r*4] - first : 0;
+    }
+    strip_genNext += count;
+
+    while (count--) {
+        if (r < strip_runCount) {
+            *out++ = strip_runs[r*4+1];
+            *out++ = strip_runs[r*4+2];
+            *out++ = strip_runs[r*4+3];
+            if (--left == 0 && ++r < strip_runCount) left = strip_runs[r*4];
+        } else {
+            *out++ = 0;
+            *out++ = 0;
+            *out++ = 0;
+        }
+    }
+    strip_runIndex = r;
+    strip_runLeft = left;
+}
+
+//A message with first run 0 starts a new frame
+void strip_setRuns(unsigned char * msg, unsigned char len) {
+    unsigned char first = msg[1];
+    unsigned char n = msg[2];
+    unsigned char i;
+
+    if (len < 3 || n > STRIP_RUNS_PER_MSG || len < 3 + n*4) return;
+    if (first + n > STRIP_RUNS) return;
+
+    for (i=0; i<n; i++) {
+        if (msg[3 + i*4] == 0) return;
+    }
+
+    if (first == 0) strip_runCount = 0;
+    if (first != strip_runCount) return;   //missed a part, wait for the next frame
+
+    for (i=0; i<n*4; i++) {
+        strip_runs[first*4 + i] = msg[3+i];
+    }
+    strip_runCount = first + n;
+}
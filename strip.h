@@ -0,0 +1,53 @@
+// Slice renderer for strips longer than RAM allows. A frame goes out in
+// windows of STRIP_SLICE LEDs, double buffered: led.asm clocks a window out
+// STRIP_STEP LEDs at a time, and after each step the generator fills the same
+// number of LEDs of the next window. The data line stays low in those gaps,
+// so the strip only latches if one reaches its reset time (50us on WS2811);
+// strip_gapMax holds the worst gap seen in Timer0 ticks. Interrupts stay off
+// for the whole frame, so a gap is only ever one generator call.
+
+#define STRIP_LEDS          510
+#define STRIP_SLICE         12      // LEDs per window (2 x 36 bytes of RAM)
+#define STRIP_STEP          4       // LEDs clocked out / generated per gap
+#define STRIP_RESET_US      50
+#define STRIP_PROFILE_ID    0x80    // tlm_sendProfile id for strip_gapMax
+
+#define STRIP_SOURCE_LEDS   125     // length of the built in gradient
+
+//Colour tables (colorlut.c, made by tools/mklut): 16 linear brightness levels
+//of gamma corrected 0-15 values plus a raw row, 256 bytes each on a 256 byte
+//boundary.
+//led.asm looks every byte up in the row picked for its channel, so changing
+//brightness or correction is just changing strip_lutRow.
+#define STRIP_LUT_ADDR      0x6000
+#define STRIP_LEVELS        16
+#define STRIP_LUT_RAW       16
+#define STRIP_LUT_ROWS      17
+
+//Payload formats (first byte)
+#define STRIP_MSG_OFFSET    42      // offset into the gradient (the sender's format)
+#define STRIP_MSG_RUNS      0x52    // first run, run count, then count,g,r,b per run
+#define STRIP_MSG_LEVEL     0x4C    // level, then g, r, b taken off in 1/256ths
+
+#define STRIP_RUNS          32
+#define STRIP_RUNS_PER_MSG  7
+
+//Fills count LEDs (GRB) starting at LED first
+typedef void (*strip_generator)(unsigned int first, unsigned char count, unsigned char * out);
+
+extern const unsigned char strip_gradient[STRIP_SOURCE_LEDS*3];
+extern const unsigned char strip_lut[STRIP_LUT_ROWS][256];
+extern unsigned char strip_lutRow[4];
+extern unsigned char strip_correction[3];
+
+extern unsigned char strip_offset;
+extern unsigned int strip_gapMax;
+
+void strip_init(void);
+void strip_render(strip_generator gen);
+void strip_setLevel(unsigned char level);
+void strip_sendWindow(void);
+
+void strip_genGradient(unsigned int first, unsigned char count, unsigned char * out);
+void strip_genRuns(unsigned int first, unsigned char count, unsigned char * out);
+void strip_setRuns(unsigned char * msg, unsigned char len);
@@ -0,0 +1,200 @@
+#include <xc.h>
+#include "telemetry.h"
+#include "serlcd.h"
+#include "nRF2401.h"
+
+unsigned char tlm_seq = 0;
+unsigned char tlm_crc = 0;
+
+unsigned char tlm_lastStatus = 0;
+unsigned char tlm_lastResult = 0;
+unsigned char tlm_repeat = 0;
+
+unsigned char tlm_crc8(unsigned char crc, unsigned char byte) {
+    unsigned char i;
+
+    crc ^= byte;
+    for (i=0; i<8; i++) {
+        if (crc & 0x80) crc = (crc << 1) ^ TLM_CRC_POLY;
+        else crc <<= 1;
+    }
+    return crc;
+}
+
+void tlm_begin(unsigned char type, unsigned char len) {
+    sendByte(TLM_SYNC);
+    tlm_crc = 0;
+    tlm_put(type);
+    tlm_put(tlm_seq++);
+    tlm_put(len);
+}
+
+void tlm_put(unsigned char byte) {
+    tlm_crc = tlm_crc8(tlm_crc, byte);
+    sendByte(byte);
+}
+
+void tlm_end(void) {
+    sendByte(tlm_crc);
+}
+
+void tlm_sendFrame(unsigned char type, unsigned char * data, unsigned char len) {
+    unsigned char i;
+
+    tlm_begin(type, len);
+    for (i=0; i<len; i++) {
+        tlm_put(data[i]);
+    }
+    tlm_end();
+}
+
+//Replaces the old text dump (~300 bytes) with a single 36 byte frame
+void tlm_sendRegisters(void) {
+    unsigned char i;
+
+    tlm_begin(TLM_REGISTERS, TLM_NRF_REGISTERS + 1);
+    tlm_put(0);
+    for (i=0; i<TLM_NRF_REGISTERS; i++) {
+        tlm_put(nrf_readRegister(i));
+    }
+    tlm_end();
+}
+
+void tlm_flushStatus(void) {
+    if (tlm_repeat == 0) return;
+
+    tlm_begin(TLM_STATUS, 3);
+    tlm_put(tlm_lastStatus);
+    tlm_put(tlm_lastResult);
+    tlm_put(tlm_repeat);
+    tlm_end();
+    tlm_repeat = 0;
+}
+
+//Coalesces per-iteration status reports into one frame per run of identical values
+void tlm_noteStatus(unsigned char status, unsigned char result) {
+    if (tlm_repeat != 0 && (status != tlm_lastStatus || result != tlm_lastResult)) {
+        tlm_flushStatus();
+    }
+
+    tlm_lastStatus = status;
+    tlm_lastResult = result;
+    if (++tlm_repeat >= TLM_STATUS_REPEAT) tlm_flushStatus();
+}
+
+//Anything past what fits in one frame is left out
+void tlm_sendCounters(unsigned int * counters, unsigned char count) {
+    unsigned char i;
+
+    if (count > TLM_MAX_PAYLOAD/2) count = TLM_MAX_PAYLOAD/2;
+    tlm_begin(TLM_COUNTERS, count*2);
+    for (i=0; i<count; i++) {
+        tlm_put(counters[i] & 0xFF);
+        tlm_put(counters[i] >> 8);
+    }
+    tlm_end();
+}
+
+void tlm_sendProfile(unsigned char id, unsigned int ticks) {
+    tlm_begin(TLM_PROFILE, 3);
+    tlm_put(id);
+    tlm_put(ticks & 0xFF);
+    tlm_put(ticks >> 8);
+    tlm_end();
+}
+
+////                            Host to device                              ////
+
+#define TLM_RX_SYNC     0
+#define TLM_RX_TYPE     1
+#define TLM_RX_SEQ      2
+#define TLM_RX_LEN      3
+#define TLM_RX_DATA     4
+#define TLM_RX_CRC      5
+
+volatile unsigned char tlm_ring[TLM_RX_RING];
+volatile unsigned char tlm_ringHead = 0;
+volatile unsigned char tlm_ringTail = 0;
+volatile unsigned char tlm_rxOverrun = 0;
+
+unsigned char tlm_rxState = TLM_RX_SYNC;
+unsigned char tlm_rxCrc;
+unsigned char tlm_rxType;
+unsigned char tlm_rxGot;
+unsigned char tlm_rxLen;
+unsigned char tlm_rx[TLM_MAX_PAYLOAD];
+
+void tlm_rxInit(void) {
+    tlm_ringHead = 0;
+    tlm_ringTail = 0;
+    tlm_rxState = TLM_RX_SYNC;
+    PIE1bits.RC1IE = 1;
+}
+
+//Called from the interrupt; one byte per RC1IF
+void tlm_rxService(void) {
+    unsigned char byte;
+    unsigned char next;
+
+    if (!PIR1bits.RC1IF) return;
+
+    if (RCSTA1bits.OERR) {
+        RCSTA1bits.CREN = 0;
+        RCSTA1bits.CREN = 1;
+        tlm_rxOverrun++;
+    }
+
+    byte = RCREG1;
+    next = (tlm_ringHead + 1) & (TLM_RX_RING - 1);
+    if (next == tlm_ringTail) {
+        tlm_rxOverrun++;
+        return;
+    }
+    tlm_ring[tlm_ringHead] = byte;
+    tlm_ringHead = next;
+}
+
+//Returns the type of the next complete frame (payload in tlm_rx), 0 if none
+unsigned char tlm_poll(void) {
+    unsigned char byte;
+
+    while (tlm_ringTail != tlm_ringHead) {
+        byte = tlm_ring[tlm_ringTail];
+        tlm_ringTail = (tlm_ringTail + 1) & (TLM_RX_RING - 1);
+
+        switch (tlm_rxState) {
+            case TLM_RX_SYNC:
+                if (byte == TLM_SYNC) {
+                    tlm_rxCrc = 0;
+                    tlm_rxState = TLM_RX_TYPE;
+                }
+                continue;
+            case TLM_RX_TYPE:
+                tlm_rxType = byte;
+                tlm_rxState = TLM_RX_SEQ;
+                break;
+            case TLM_RX_SEQ:
+                tlm_rxState = TLM_RX_LEN;
+                break;
+            case TLM_RX_LEN:
+                if (byte > TLM_MAX_PAYLOAD) {
+                    tlm_rxState = TLM_RX_SYNC;
+                    continue;
+                }
+                tlm_rxLen = byte;
+                tlm_rxGot = 0;
+                tlm_rxState = byte ? TLM_RX_DATA : TLM_RX_CRC;
+                break;
+            case TLM_RX_DATA:
+                tlm_rx[tlm_rxGot++] = byte;
+                if (tlm_rxGot == tlm_rxLen) tlm_rxState = TLM_RX_CRC;
+                break;
+            case TLM_RX_CRC:
+                tlm_rxState = TLM_RX_SYNC;
+                if (byte == tlm_rxCrc) return tlm_rxType;
+                continue;
+        }
+        tlm_rxCrc = tlm_crc8(tlm_rxCrc, byte);
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include "telemetry_protocol.h"
+
+unsigned char tlm_crc8(unsigned char crc, unsigned char byte);
+
+void tlm_begin(unsigned char type, unsigned char len);
+void tlm_put(unsigned char byte);
+void tlm_end(void);
+
+void tlm_sendFrame(unsigned char type, unsigned char * data, unsigned char len);
+void tlm_sendRegisters(void);
+void tlm_noteStatus(unsigned char status, unsigned char result);
+void tlm_flushStatus(void);
+void tlm_sendCounters(unsigned int * counters, unsigned char count);
+void tlm_sendProfile(unsigned char id, unsigned int ticks);
+
+//Host to device frames are collected by tlm_rxService() from the interrupt
+//and parsed by tlm_poll() from a task; the payload is left in tlm_rx.
+#define TLM_RX_RING         64      // power of two
+
+extern unsigned char tlm_rx[TLM_MAX_PAYLOAD];
+extern unsigned char tlm_rxLen;
+extern volatile unsigned char tlm_rxOverrun;
+
+void tlm_rxInit(void);
+void tlm_rxService(void);
+unsigned char tlm_poll(void);
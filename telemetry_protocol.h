@@ -0,0 +1,52 @@
+// Framed binary telemetry shared by the firmware (telemetry.c) and the host
+// tools (tools/). Every frame on the wire is:
+//
+//   SYNC | type | seq | len | payload[len] | crc8
+//
+// The CRC-8 (poly 0x07, init 0) covers type, seq, len and the payload. seq
+// increments once per frame so the host can count dropped frames. Bytes that
+// arrive outside a frame are plain text (banners) and are passed through.
+
+#define TLM_SYNC            0xA5
+#define TLM_MAX_PAYLOAD     40
+#define TLM_CRC_POLY        0x07
+
+// Frame types
+#define TLM_REGISTERS       0x01    // first register, then one byte per register
+#define TLM_STATUS          0x02    // status, result, repeat count
+#define TLM_COUNTERS        0x03    // n little endian 16 bit counters
+#define TLM_PROFILE         0x04    // id, 16 bit Timer0 ticks (little endian)
+#define TLM_TRACE           0x05    // 32 bit timestamp, pipe, payload bytes
+#define TLM_LOSS            0x06    // 32 bit timestamp, reason
+#define TLM_ROUTES          0x07    // (node, via, hops) per known route
+#define TLM_EEACK           0x08    // addr lo, addr hi, TLM_EE_* status
+#define TLM_OTAACK          0x09    // send result, latest ACK payload bytes (if any)
+
+// Host to device frames (same framing, own seq counter)
+#define TLM_INJECT          0x10    // pipe, payload bytes: fed to the receive path
+#define TLM_CAPTURE         0x11    // 1 = stream TLM_TRACE/TLM_LOSS, 0 = stop
+#define TLM_EEWRITE         0x12    // flags, addr lo, addr hi, data: pattern EEPROM write
+#define TLM_OTA             0x13    // node id, payload: sent as is, answered by TLM_OTAACK
+#define TLM_OTADATA         0x14    // node id, payload: streamed, answered by TLM_OTAACK once sent
+
+// Trace timestamps are Timer0 ticks (62.5ns) extended by the scheduler tick
+// count, so they wrap every 2^32 ticks (~268s). TLM_TRACE payload length is
+// the frame length minus TLM_TRACE_HEADER.
+#define TLM_TRACE_HEADER    5
+#define TLM_TICKS_PER_US    16
+
+// TLM_LOSS reasons
+#define TLM_LOSS_FIFO_FULL  0x01    // RX FIFO was full, the radio dropped what came next
+#define TLM_LOSS_LENGTH     0x02    // bad payload width, RX FIFO flushed
+#define TLM_LOSS_INJECT     0x03    // host bytes overran the UART receive ring
+
+// TLM_EEACK status
+#define TLM_EE_OK           0x00
+#define TLM_EE_BUSY         0x01    // write queue full, send the chunk again
+#define TLM_EE_LENGTH       0x02    // too long (or too long to forward over RF)
+
+#define TLM_NRF_REGISTERS   0x1E    // 0x00 - 0x1D
+
+// A status frame is only emitted when status/result change or after this
+// many identical events, so a steady link costs one frame per burst.
+#define TLM_STATUS_REPEAT   16
@@ -0,0 +1,27 @@
+#include <xc.h>
+#include "tick.h"
+
+//TMR0H is latched when TMR0L is read, so the low byte must be read first
+unsigned int tick_now(void) {
+    unsigned char low = TMR0L;
+    return ((unsigned int)TMR0H << 8) | low;
+}
+
+void tick_wait(unsigned int ticks) {
+    unsigned int start = tick_now();
+    while ((unsigned int)(tick_now() - start) < ticks);
+}
+
+void tick_waitUs(unsigned int us) {
+    while (us > TICK_WAIT_MAX) {
+        tick_wait(TICK_WAIT_MAX * TICKS_PER_US);
+        us -= TICK_WAIT_MAX;
+    }
+    tick_wait(us * TICKS_PER_US);
+}
+
+void tick_waitMs(unsigned int ms) {
+    while (ms--) {
+        tick_wait(1000 * TICKS_PER_US);
+    }
+}
@@ -0,0 +1,10 @@
+// Free running Timer0 time base. setup() runs Timer0 in 16 bit mode from
+// Fosc/4 with no prescaler: 16 ticks per microsecond, wrapping every 4.096ms.
+
+#define TICKS_PER_US    16
+#define TICK_WAIT_MAX   4000    // longest single wait in us (under one wrap)
+
+unsigned int tick_now(void);
+void tick_wait(unsigned int ticks);
+void tick_waitUs(unsigned int us);
+void tick_waitMs(unsigned int ms);
@@ -0,0 +1,719 @@
+// Code size and cycle budget tracker.
+//
+// Reads the per-function map (funclist: "_name: CODE, addr 0 size") and/or an
+// MPLAB X disassembly listing (disassembly/listing.disasm) and reports, per
+// function, the code size, a static worst-case cycle estimate and the
+// hardware stack depth of its call tree. Reports can be saved as a baseline,
+// compared against one, and checked against a budget file.
+//
+//   cc -o codebudget codebudget.c
+//   ./codebudget -m funclist -l disassembly/listing.disasm -B tools/budgets.txt -o baseline.txt
+//   ./codebudget -m funclist -l disassembly/listing.disasm -b baseline.txt -B tools/budgets.txt
+//
+// Cycle estimates count every instruction once, take the slow path of every
+// branch and skip, add the callee's estimate at each call and multiply loop
+// bodies (backward branches) by a loop bound: -L for all loops, or a "loop"
+// line in the budget file for one function. Calls that can't be resolved
+// (procedural abstraction stubs, library labels) mark the estimate with '+'.
+//
+// A saved report ends with the loop bounds it was made with ("loop * n" for
+// the default); comparing against it reuses them unless -L/-B say otherwise.
+// The exit status is nonzero on a regression against the baseline or a
+// budget overrun.
+//
+// Budget file lines, with names as they appear in the report:
+//   name  max_size  max_cycles     ('-' for no limit)
+//   loop  name      bound
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_FUNCS   512
+#define MAX_INSNS   8192
+#define NAME_LEN    64
+#define HW_STACK    31
+
+#define UNKNOWN     -1L
+
+struct insn {
+    unsigned addr;
+    int words;
+    int func;
+    char mnem[16];
+    char operand[NAME_LEN];
+};
+
+struct func {
+    char name[NAME_LEN];
+    long size;          // from the map, else from the listing
+    unsigned addr;
+    int in_map;
+    int listed;
+    long listing_size;
+    long loop_bound;    // 0 = use the default
+    long cycles;
+    int incomplete;
+    int depth;
+    int state;          // 0 = not visited, 1 = in progress, 2 = done
+    long budget_size;
+    long budget_cycles;
+    long base_size;
+    long base_cycles;
+    long base_bound;    // loop bound the baseline was made with, 0 = default
+    int in_base;
+};
+
+static struct func funcs[MAX_FUNCS];
+static int nfuncs;
+static struct insn insns[MAX_INSNS];
+static int ninsns;
+static long default_bound = 1;
+static long base_default = 0;   // default bound saved with the baseline
+
+// XC8 map names carry a leading underscore; report names are C names
+static const char *strip(const char *name) {
+    return name[0] == '_' ? name + 1 : name;
+}
+
+static int find_func(const char *name) {
+    int i;
+
+    for (i = 0; i < nfuncs; i++) {
+        if (strcmp(funcs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int add_func(const char *name) {
+    int i = find_func(name);
+
+    if (i >= 0) return i;
+    if (nfuncs == MAX_FUNCS) {
+        fprintf(stderr, "too many functions\n");
+        exit(1);
+    }
+    i = nfuncs++;
+    memset(&funcs[i], 0, sizeof(funcs[i]));
+    snprintf(funcs[i].name, NAME_LEN, "%s", name);
+    funcs[i].size = UNKNOWN;
+    funcs[i].cycles = UNKNOWN;
+    funcs[i].budget_size = UNKNOWN;
+    funcs[i].budget_cycles = UNKNOWN;
+    funcs[i].base_size = UNKNOWN;
+    funcs[i].base_cycles = UNKNOWN;
+    return i;
+}
+
+////                            Map (funclist)                              ////
+
+// side: 0 = take HEAD ("ours") of a merge conflict, 1 = take the other side
+static void read_map(const char *path, int side) {
+    char line[256];
+    char name[NAME_LEN];
+    char class[32];
+    unsigned addr;
+    long size, total = UNKNOWN, sum = 0;
+    int region = 0;     // 0 = outside conflict, 1 = ours, 2 = theirs
+    int conflict = 0;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "<<<<<<<", 7) == 0) {
+            region = 1;
+            conflict = 1;
+            continue;
+        }
+        if (strncmp(line, "=======", 7) == 0) {
+            region = 2;
+            continue;
+        }
+        if (strncmp(line, ">>>>>>>", 7) == 0) {
+            region = 0;
+            continue;
+        }
+        if (region != 0 && region - 1 != side) continue;
+
+        if (sscanf(line, "Total: %ld", &size) == 1) {
+            total = size;
+        } else if (sscanf(line, "%63[^:]: %31[^,], %u %*d %ld", name, class, &addr, &size) == 4) {
+            int i;
+
+            sum += size;
+            if (strcmp(class, "CODE") != 0) continue;
+            i = add_func(strip(name));
+            funcs[i].addr = addr;
+            funcs[i].size = size;
+            funcs[i].in_map = 1;
+        }
+    }
+    fclose(f);
+
+    if (conflict) {
+        fprintf(stderr, "%s: unresolved merge conflict, using the %s side\n",
+                path, side ? "incoming" : "HEAD");
+    }
+    if (total != UNKNOWN && total != sum) {
+        fprintf(stderr, "%s: Total: %ld but the entries add up to %ld\n", path, total, sum);
+    }
+}
+
+////                            Listing                                     ////
+
+static int is_keyword(const char *word) {
+    static const char *words[] = {"if", "while", "for", "switch", "return", "sizeof", "else", NULL};
+    int i;
+
+    for (i = 0; words[i]; i++) {
+        if (strcmp(word, words[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+// Recognises "type name(args) {" (or without the brace) as a function header.
+static int function_header(const char *src, char *name) {
+    const char *p = src;
+    const char *open, *close, *end;
+    const char *n;
+    int len;
+
+    while (isspace((unsigned char)*p)) p++;
+    if (!isalpha((unsigned char)*p) && *p != '_') return 0;
+    if (strncmp(p, "#", 1) == 0) return 0;
+
+    open = strchr(p, '(');
+    close = strrchr(p, ')');
+    if (!open || !close || close < open) return 0;
+    if (strchr(close, ';') || strchr(p, '=')) return 0;
+
+    end = close + 1;
+    while (isspace((unsigned char)*end)) end++;
+    if (*end != 0 && *end != '{') return 0;
+
+    // name directly before '(' and at least one word (the type) before it
+    n = open;
+    while (n > p && isspace((unsigned char)n[-1])) n--;
+    len = 0;
+    while (n > p && (isalnum((unsigned char)n[-1]) || n[-1] == '_')) {
+        n--;
+        len++;
+    }
+    if (len == 0 || n == p || len >= NAME_LEN) return 0;
+
+    memcpy(name, n, len);
+    name[len] = 0;
+    return !is_keyword(name);
+}
+
+static int two_word(const char *mnem) {
+    return strcmp(mnem, "MOVFF") == 0 || strcmp(mnem, "CALL") == 0 ||
+           strcmp(mnem, "GOTO") == 0 || strcmp(mnem, "LFSR") == 0 ||
+           strcmp(mnem, "MOVSF") == 0 || strcmp(mnem, "MOVSS") == 0;
+}
+
+static void read_listing(const char *path) {
+    char line[512];
+    char name[NAME_LEN];
+    char section[NAME_LEN] = "startup";
+    int current = -1;
+    int pending_word = 0;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned addr, word;
+        char mnem[16];
+        char operand[NAME_LEN];
+        int fields;
+
+        line[strcspn(line, "\r\n")] = 0;
+
+        if (strncmp(line, "---", 3) == 0) {
+            // new source file; instructions without a recognised function
+            // header are attributed to the file itself
+            const char *slash = strrchr(line, '/');
+            const char *dot;
+            int len;
+
+            slash = slash ? slash + 1 : line + 4;
+            dot = strchr(slash, '.');
+            len = dot ? (int)(dot - slash) : (int)strcspn(slash, " ");
+            if (len >= NAME_LEN) len = NAME_LEN - 1;
+            memcpy(section, slash, len);
+            section[len] = 0;
+            current = -1;
+            continue;
+        }
+
+        if (isdigit((unsigned char)line[0])) {
+            const char *colon = strchr(line, ':');
+            const char *p = line;
+
+            while (isdigit((unsigned char)*p)) p++;
+            if (colon == p && function_header(colon + 1, name)) {
+                current = add_func(name);
+                funcs[current].listed = 1;
+                continue;
+            }
+        }
+
+        fields = sscanf(line, "%4x %4x %15s %63[^\n]", &addr, &word, mnem, operand);
+        if (fields < 3 || strlen(line) < 10 || line[4] != ' ') continue;
+
+        if (pending_word) {
+            // second word of MOVFF/CALL/GOTO/LFSR, shown as NOP
+            pending_word = 0;
+            insns[ninsns - 1].words = 2;
+            continue;
+        }
+
+        if (ninsns == MAX_INSNS) {
+            fprintf(stderr, "listing too long\n");
+            exit(1);
+        }
+        if (current < 0) {
+            current = add_func(section);
+            funcs[current].listed = 1;
+        }
+
+        insns[ninsns].addr = addr;
+        insns[ninsns].words = 1;
+        insns[ninsns].func = current;
+        snprintf(insns[ninsns].mnem, sizeof(insns[ninsns].mnem), "%s", mnem);
+        snprintf(insns[ninsns].operand, sizeof(insns[ninsns].operand), "%s", fields == 4 ? operand : "");
+        if (!funcs[current].addr || addr < funcs[current].addr) {
+            if (!funcs[current].in_map) funcs[current].addr = addr;
+        }
+        ninsns++;
+
+        pending_word = two_word(mnem);
+    }
+    fclose(f);
+}
+
+////                            Analysis                                    ////
+
+static int is_call(const char *m) {
+    return strcmp(m, "CALL") == 0 || strcmp(m, "RCALL") == 0;
+}
+
+static int is_jump(const char *m) {
+    return strcmp(m, "GOTO") == 0 || strcmp(m, "BRA") == 0 ||
+           (m[0] == 'B' && strlen(m) <= 4 && strcmp(m, "BSF") != 0 &&
+            strcmp(m, "BCF") != 0 && strcmp(m, "BTG") != 0);
+}
+
+static int is_skip(const char *m) {
+    static const char *skips[] = {"BTFSS", "BTFSC", "DECFSZ", "INCFSZ", "DCFSNZ",
+                                  "INFSNZ", "CPFSEQ", "CPFSGT", "CPFSLT", "TSTFSZ", NULL};
+    int i;
+
+    for (i = 0; skips[i]; i++) {
+        if (strcmp(m, skips[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+static int insn_cycles(int i) {
+    const char *m = insns[i].mnem;
+
+    if (is_skip(m)) {
+        return (i + 1 < ninsns && insns[i + 1].words == 2) ? 3 : 2;
+    }
+    if (is_call(m) || is_jump(m) || strncmp(m, "RET", 3) == 0 ||
+        strncmp(m, "TBL", 3) == 0 || strcmp(m, "MOVFF") == 0 ||
+        strcmp(m, "LFSR") == 0 || strcmp(m, "MOVSF") == 0 || strcmp(m, "MOVSS") == 0) {
+        return 2;
+    }
+    return 1;
+}
+
+// Owner of the instruction at addr, or -1
+static int func_at(unsigned addr) {
+    int i;
+
+    for (i = 0; i < ninsns; i++) {
+        if (insns[i].addr == addr) return insns[i].func;
+    }
+    for (i = 0; i < nfuncs; i++) {
+        if (funcs[i].in_map && funcs[i].size > 0 &&
+            addr >= funcs[i].addr && addr < funcs[i].addr + funcs[i].size) return i;
+    }
+    return -1;
+}
+
+// Resolves a branch/call operand to an address; returns 0 when unknown
+static int target_addr(const char *operand, unsigned *addr) {
+    char name[NAME_LEN];
+    int f;
+
+    if (strncmp(operand, "0x", 2) == 0) {
+        *addr = (unsigned)strtoul(operand, NULL, 16);
+        return 1;
+    }
+    sscanf(operand, "%63[^, ]", name);
+    f = find_func(strip(name));
+    if (f >= 0 && (funcs[f].in_map || funcs[f].listed)) {
+        *addr = funcs[f].addr;
+        return 1;
+    }
+    return 0;
+}
+
+static void analyse(int f);
+
+static void analyse(int f) {
+    static double weight[MAX_INSNS];
+    static char done[MAX_INSNS];
+    int first = -1, last = -1;
+    int i, j, k;
+    long bound = funcs[f].loop_bound ? funcs[f].loop_bound : default_bound;
+    double total = 0;
+    int depth = 0;
+
+    if (funcs[f].state == 2) return;
+    if (funcs[f].state == 1) {
+        funcs[f].incomplete = 1;   // recursion
+        return;
+    }
+    funcs[f].state = 1;
+
+    for (i = 0; i < ninsns; i++) {
+        if (insns[i].func != f) continue;
+        weight[i] = 1;
+        done[i] = 0;
+        if (first < 0) first = i;
+        last = i;
+    }
+    if (first < 0) {
+        funcs[f].state = 2;
+        return;
+    }
+
+    // Loops: a backward branch inside the function repeats [target, branch].
+    // Smaller ranges are applied first so nested loops multiply.
+    for (;;) {
+        int best = -1;
+        unsigned best_len = ~0u, t;
+
+        for (i = first; i <= last; i++) {
+            unsigned len;
+
+            if (insns[i].func != f || !is_jump(insns[i].mnem) || done[i]) continue;
+            if (!target_addr(insns[i].operand, &t) || t > insns[i].addr) continue;
+            if (func_at(t) != f) continue;
+            len = insns[i].addr - t;
+            if (len < best_len) {
+                best_len = len;
+                best = i;
+            }
+        }
+        if (best < 0) break;
+
+        target_addr(insns[best].operand, &t);
+        for (j = first; j <= last; j++) {
+            if (insns[j].func == f && insns[j].addr >= t && insns[j].addr <= insns[best].addr) {
+                weight[j] *= bound;
+            }
+        }
+        done[best] = 1;
+    }
+
+    for (i = first; i <= last; i++) {
+        unsigned t;
+        int callee = -1;
+
+        if (insns[i].func != f) continue;
+        total += weight[i] * insn_cycles(i);
+
+        if (is_call(insns[i].mnem) || is_jump(insns[i].mnem)) {
+            if (target_addr(insns[i].operand, &t)) {
+                callee = func_at(t);
+            } else if (is_call(insns[i].mnem) || strcmp(insns[i].mnem, "BRA") == 0 ||
+                       strcmp(insns[i].mnem, "GOTO") == 0) {
+                funcs[f].incomplete = 1;
+            }
+        }
+        if (callee < 0 || callee == f) continue;
+
+        analyse(callee);
+        if (funcs[callee].cycles != UNKNOWN) total += weight[i] * funcs[callee].cycles;
+        if (funcs[callee].incomplete) funcs[f].incomplete = 1;
+
+        k = funcs[callee].depth + (is_call(insns[i].mnem) ? 1 : 0);
+        if (k > depth) depth = k;
+    }
+
+    funcs[f].cycles = (long)total;
+    funcs[f].depth = depth;
+    funcs[f].state = 2;
+}
+
+////                            Baseline / budgets                          ////
+
+static void read_baseline(const char *path) {
+    char line[256], name[NAME_LEN], size[32], cycles[32];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int i;
+
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %31s %31s", name, size, cycles) != 3) continue;
+        if (strcmp(name, "loop") == 0) {
+            if (strcmp(size, "*") == 0) base_default = atol(cycles);
+            else funcs[add_func(size)].base_bound = atol(cycles);
+            continue;
+        }
+        i = add_func(name);
+        funcs[i].in_base = 1;
+        funcs[i].base_size = strcmp(size, "-") ? atol(size) : UNKNOWN;
+        funcs[i].base_cycles = strcmp(cycles, "-") ? atol(cycles) : UNKNOWN;
+    }
+    fclose(f);
+}
+
+static void read_budgets(const char *path) {
+    char line[256], a[NAME_LEN], b[NAME_LEN], c[32];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int n, i;
+
+        if (line[0] == '#') continue;
+        n = sscanf(line, "%63s %63s %31s", a, b, c);
+        if (n == 3 && strcmp(a, "loop") == 0) {
+            funcs[add_func(b)].loop_bound = atol(c);
+        } else if (n == 3) {
+            i = add_func(a);
+            funcs[i].budget_size = strcmp(b, "-") ? atol(b) : UNKNOWN;
+            funcs[i].budget_cycles = strcmp(c, "-") ? atol(c) : UNKNOWN;
+        }
+    }
+    fclose(f);
+}
+
+////                            Report                                      ////
+
+static int by_addr(const void *a, const void *b) {
+    const struct func *x = a, *y = b;
+
+    if (x->addr != y->addr) return x->addr < y->addr ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+static void field(char *buf, long v) {
+    if (v == UNKNOWN) strcpy(buf, "-");
+    else sprintf(buf, "%ld", v);
+}
+
+static void write_report(FILE *out) {
+    char size[32], cycles[32];
+    int i;
+
+    fprintf(out, "# %-28s %8s %10s %6s\n", "function", "size", "cycles", "depth");
+    for (i = 0; i < nfuncs; i++) {
+        if (!funcs[i].in_map && !funcs[i].listed) continue;
+        field(size, funcs[i].size);
+        field(cycles, funcs[i].cycles);
+        if (funcs[i].incomplete && funcs[i].cycles != UNKNOWN) strcat(cycles, "+");
+        fprintf(out, "%-30s %8s %10s %6d\n", funcs[i].name, size, cycles, funcs[i].depth);
+    }
+
+    // the bounds the cycle estimates were made with, so a compare can use them
+    fprintf(out, "loop %-25s %8ld\n", "*", default_bound);
+    for (i = 0; i < nfuncs; i++) {
+        if (funcs[i].loop_bound) fprintf(out, "loop %-25s %8ld\n", funcs[i].name, funcs[i].loop_bound);
+    }
+}
+
+// Bounds saved with the baseline fill in whatever -L/-B leave open; bounds
+// that differ from the baseline's are reported, their cycle deltas are not
+// like for like
+static void apply_base_bounds(int have_default) {
+    int i;
+
+    if (base_default && !have_default) default_bound = base_default;
+    if (base_default && default_bound != base_default) {
+        printf("note: default loop bound %ld, baseline used %ld\n", default_bound, base_default);
+    }
+    for (i = 0; i < nfuncs; i++) {
+        if (!funcs[i].base_bound) continue;
+        if (!funcs[i].loop_bound) funcs[i].loop_bound = funcs[i].base_bound;
+        else if (funcs[i].loop_bound != funcs[i].base_bound) {
+            printf("note: loop bound for %s is %ld, baseline used %ld\n",
+                   funcs[i].name, funcs[i].loop_bound, funcs[i].base_bound);
+        }
+    }
+}
+
+static void print_delta(const char *what, long base, long now) {
+    if (base == UNKNOWN || now == UNKNOWN || base == now) return;
+    printf("  %s %ld -> %ld (%+ld)\n", what, base, now, now - base);
+}
+
+// Returns 1 if any function grew in size or cycles
+static int compare_baseline(void) {
+    long base_total = 0, total = 0;
+    int regressed = 0;
+    int i;
+
+    printf("changes against baseline:\n");
+    for (i = 0; i < nfuncs; i++) {
+        int present = funcs[i].in_map || funcs[i].listed;
+
+        if (funcs[i].in_base && !present) {
+            printf("%s: removed\n", funcs[i].name);
+        } else if (!funcs[i].in_base && present) {
+            printf("%s: new\n", funcs[i].name);
+        } else if (funcs[i].in_base &&
+                   (funcs[i].base_size != funcs[i].size || funcs[i].base_cycles != funcs[i].cycles)) {
+            printf("%s:\n", funcs[i].name);
+            print_delta("size", funcs[i].base_size, funcs[i].size);
+            print_delta("cycles", funcs[i].base_cycles, funcs[i].cycles);
+            if (funcs[i].base_size != UNKNOWN && funcs[i].size != UNKNOWN &&
+                funcs[i].size > funcs[i].base_size) regressed = 1;
+            if (funcs[i].base_cycles != UNKNOWN && funcs[i].cycles != UNKNOWN &&
+                funcs[i].cycles > funcs[i].base_cycles) regressed = 1;
+        }
+        if (funcs[i].in_base && funcs[i].base_size != UNKNOWN) base_total += funcs[i].base_size;
+        if (present && funcs[i].size != UNKNOWN) total += funcs[i].size;
+    }
+    printf("total size %ld -> %ld (%+ld)\n", base_total, total, total - base_total);
+    if (regressed) printf("REGRESSION against baseline\n");
+    return regressed;
+}
+
+static int check_budgets(void) {
+    int failed = 0;
+    int i;
+
+    for (i = 0; i < nfuncs; i++) {
+        if (funcs[i].budget_size != UNKNOWN && funcs[i].size != UNKNOWN &&
+            funcs[i].size > funcs[i].budget_size) {
+            printf("OVER BUDGET %s: size %ld > %ld\n", funcs[i].name, funcs[i].size, funcs[i].budget_size);
+            failed = 1;
+        }
+        if (funcs[i].budget_cycles != UNKNOWN && funcs[i].cycles != UNKNOWN &&
+            funcs[i].cycles > funcs[i].budget_cycles) {
+            printf("OVER BUDGET %s: cycles %ld%s > %ld\n", funcs[i].name, funcs[i].cycles,
+                   funcs[i].incomplete ? "+" : "", funcs[i].budget_cycles);
+            failed = 1;
+        }
+        if ((funcs[i].budget_size != UNKNOWN || funcs[i].budget_cycles != UNKNOWN) &&
+            !funcs[i].in_map && !funcs[i].listed) {
+            printf("budget for unknown function %s\n", funcs[i].name);
+        }
+    }
+    return failed;
+}
+
+static void stack_summary(void) {
+    int main_depth = -1, isr_depth = 0;
+    int i;
+
+    for (i = 0; i < nfuncs; i++) {
+        if (strcmp(funcs[i].name, "main") == 0) main_depth = funcs[i].depth + 1;
+        if (strstr(funcs[i].name, "interrupt") || strstr(funcs[i].name, "ISR")) {
+            if (funcs[i].depth + 1 > isr_depth) isr_depth = funcs[i].depth + 1;
+        }
+    }
+    if (main_depth < 0) return;
+    printf("hardware stack: main %d + interrupt %d = %d of %d\n",
+           main_depth, isr_depth, main_depth + isr_depth, HW_STACK);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [-m funclist] [-l listing] [-s head|incoming] [-L loop_bound]\n"
+            "          [-o report] [-b baseline] [-B budgets]\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *map = NULL, *listing = NULL, *report = NULL, *baseline = NULL, *budgets = NULL;
+    int side = 0;
+    int have_default = 0;
+    int failed = 0;
+    int mismatched = 0;
+    int i, opt;
+
+    while ((opt = getopt(argc, argv, "m:l:s:L:o:b:B:")) != -1) {
+        switch (opt) {
+        case 'm': map = optarg; break;
+        case 'l': listing = optarg; break;
+        case 's': side = strcmp(optarg, "head") != 0; break;
+        case 'L': default_bound = atol(optarg); have_default = 1; break;
+        case 'o': report = optarg; break;
+        case 'b': baseline = optarg; break;
+        case 'B': budgets = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (!map && !listing) usage(argv[0]);
+
+    if (map) read_map(map, side);
+    if (listing) read_listing(listing);
+    if (budgets) read_budgets(budgets);
+    if (baseline) {
+        read_baseline(baseline);
+        apply_base_bounds(have_default);
+    }
+
+    for (i = 0; i < ninsns; i++) {
+        funcs[insns[i].func].listing_size += insns[i].words * 2;
+    }
+    for (i = 0; i < nfuncs; i++) {
+        if (!funcs[i].in_map && funcs[i].listed) funcs[i].size = funcs[i].listing_size;
+        if (funcs[i].in_map && funcs[i].listed && funcs[i].size != funcs[i].listing_size) mismatched++;
+    }
+    if (mismatched) {
+        fprintf(stderr, "map and listing disagree on the size of %d function(s); "
+                "are they from the same build?\n", mismatched);
+    }
+    for (i = 0; i < nfuncs; i++) {
+        if (funcs[i].listed) analyse(i);
+    }
+
+    // sort for the report; insns refer to functions by index, so only
+    // sort once the analysis is done
+    qsort(funcs, nfuncs, sizeof(funcs[0]), by_addr);
+
+    if (report) {
+        FILE *out = fopen(report, "w");
+
+        if (!out) {
+            perror(report);
+            return 1;
+        }
+        write_report(out);
+        fclose(out);
+    } else if (!baseline) {
+        write_report(stdout);
+    }
+
+    if (listing) stack_summary();
+    if (baseline) failed |= compare_baseline();
+    if (budgets) failed |= check_budgets();
+
+    return failed;
+}
@@ -0,0 +1,268 @@
+// Builds a pattern image for the strip EEPROM (see ../pattern.h) and loads it
+// through a board's UART as TLM_EEWRITE frames, one chunk per TLM_EEACK. With
+// -f the board also forwards every chunk to its receiver over RF, and the
+// TLM_EEACK waits for the receiver's answer.
+//
+//   cc -o eeload eeload.c link.c
+//   ./eeload -o image.bin patterns.txt                 (build only)
+//   ./eeload [-b baud] [-f] [-r] file /dev/ttyUSB0
+//
+// The spec is line based; '#' starts a comment:
+//
+//   pattern <hold>                 new pattern, each frame shown hold x 40ms
+//   frame <count> <g> <r> <b> ...  one frame, up to 31 runs of count LEDs
+//
+// -r loads file as a ready made image instead of a spec. The directory page
+// goes out last, so a board never plays a half written pattern.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include "link.h"
+
+// Keep in step with ../pattern.h and ../eeprom.h
+#define EE_SIZE         32768
+#define EE_PAGE         64
+#define PAT_MAGIC       0xA7
+#define PAT_MAX         15
+#define PAT_DIR_ENTRY   4
+#define PAT_FRAME_BYTES 128
+#define PAT_FRAME_RUNS  31
+#define PAT_WRITE_MAX   32
+#define PAT_FORWARD     0x01
+
+#define RF_CHUNK        28      // fits a PAT_MSG_WRITE payload
+#define ACK_TIMEOUT_MS  500
+#define RETRIES         20
+
+static unsigned char image[EE_SIZE];
+static size_t image_len;
+
+static int build(const char *path) {
+    char line[1024];
+    unsigned char *frame;
+    int patterns = 0, lineno = 0;
+    size_t next = EE_PAGE;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    memset(image, 0, sizeof(image));
+    image[0] = PAT_MAGIC;
+
+    while (fgets(line, sizeof(line), f)) {
+        char *tok, *hash;
+        unsigned char *entry;
+
+        lineno++;
+        if ((hash = strchr(line, '#')) != NULL) *hash = 0;
+        tok = strtok(line, " \t\r\n");
+        if (!tok) continue;
+
+        if (!strcmp(tok, "pattern")) {
+            if (patterns == PAT_MAX) {
+                fprintf(stderr, "%s:%d: more than %d patterns\n", path, lineno, PAT_MAX);
+                goto fail;
+            }
+            tok = strtok(NULL, " \t\r\n");
+            entry = image + 2 + patterns * PAT_DIR_ENTRY;
+            entry[0] = (next / EE_PAGE) >> 8;
+            entry[1] = (next / EE_PAGE) & 0xFF;
+            entry[2] = 0;
+            entry[3] = tok ? atoi(tok) : 1;
+            patterns++;
+        } else if (!strcmp(tok, "frame")) {
+            int runs = 0, v[4], i;
+
+            if (!patterns) {
+                fprintf(stderr, "%s:%d: frame before pattern\n", path, lineno);
+                goto fail;
+            }
+            entry = image + 2 + (patterns - 1) * PAT_DIR_ENTRY;
+            if (next + PAT_FRAME_BYTES > EE_SIZE || entry[2] == 255) {
+                fprintf(stderr, "%s:%d: image full\n", path, lineno);
+                goto fail;
+            }
+            frame = image + next;
+
+            while ((tok = strtok(NULL, " \t\r\n")) != NULL) {
+                for (i = 0; i < 4; i++) {
+                    if (i && (tok = strtok(NULL, " \t\r\n")) == NULL) break;
+                    v[i] = strtol(tok, NULL, 0);
+                }
+                if (i < 4 || v[0] < 1 || v[0] > 255) {
+                    fprintf(stderr, "%s:%d: runs are count g r b, count 1-255\n", path, lineno);
+                    goto fail;
+                }
+                if (runs == PAT_FRAME_RUNS) {
+                    fprintf(stderr, "%s:%d: more than %d runs\n", path, lineno, PAT_FRAME_RUNS);
+                    goto fail;
+                }
+                for (i = 0; i < 4; i++) frame[1 + runs * 4 + i] = v[i];
+                runs++;
+            }
+            frame[0] = runs;
+            entry[2]++;
+            next += PAT_FRAME_BYTES;
+        } else {
+            fprintf(stderr, "%s:%d: unknown keyword %s\n", path, lineno, tok);
+            goto fail;
+        }
+    }
+    fclose(f);
+
+    image[1] = patterns;
+    image_len = next;
+    fprintf(stderr, "%d patterns, %zu bytes\n", patterns, image_len);
+    return 0;
+
+fail:
+    fclose(f);
+    return -1;
+}
+
+static int load_raw(const char *path) {
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    image_len = fread(image, 1, sizeof(image), f);
+    fclose(f);
+    if (image_len < EE_PAGE || image[0] != PAT_MAGIC) {
+        fprintf(stderr, "%s: not a pattern image\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Waits for the TLM_EEACK of addr; returns its status or -1 on timeout
+static int wait_ack(int fd, struct link_parser *parser, unsigned addr) {
+    unsigned char byte;
+    struct timeval tv;
+    fd_set fds;
+
+    for (;;) {
+        FD_ZERO(&fds);
+        FD_SET(fd, &fds);
+        tv.tv_sec = 0;
+        tv.tv_usec = ACK_TIMEOUT_MS * 1000;
+        if (select(fd + 1, &fds, NULL, NULL, &tv) <= 0) return -1;
+        if (read(fd, &byte, 1) != 1) return -1;
+
+        if (link_feed(parser, byte) != LINK_FRAME) continue;
+        if (parser->frame.type != TLM_EEACK || parser->frame.len < 3) continue;
+        if ((unsigned)(parser->frame.payload[0] | parser->frame.payload[1] << 8) != addr) continue;
+        return parser->frame.payload[2];
+    }
+}
+
+static int send_chunk(int fd, struct link_parser *parser, unsigned char *seq,
+                      unsigned addr, size_t len, int forward) {
+    unsigned char payload[3 + PAT_WRITE_MAX];
+    unsigned char out[TLM_MAX_PAYLOAD + 5];
+    int n, tries, status;
+
+    payload[0] = forward ? PAT_FORWARD : 0;
+    payload[1] = addr & 0xFF;
+    payload[2] = addr >> 8;
+    memcpy(payload + 3, image + addr, len);
+
+    for (tries = 0; tries < RETRIES; tries++) {
+        n = link_encode(out, TLM_EEWRITE, (*seq)++, payload, len + 3);
+        if (write(fd, out, n) != n) {
+            perror("write");
+            return -1;
+        }
+        status = wait_ack(fd, parser, addr);
+        if (status == TLM_EE_OK) return 0;
+        if (status == TLM_EE_LENGTH) {
+            fprintf(stderr, "0x%04X: chunk rejected\n", addr);
+            return -1;
+        }
+        if (status == TLM_EE_BUSY) usleep(10000);
+    }
+    fprintf(stderr, "0x%04X: no ack\n", addr);
+    return -1;
+}
+
+static int load(int fd, int forward) {
+    struct link_parser parser;
+    unsigned char seq = 0;
+    size_t chunk = forward ? RF_CHUNK : PAT_WRITE_MAX;
+    size_t addr, len;
+
+    link_reset(&parser);
+
+    for (addr = EE_PAGE; addr < image_len; addr += len) {
+        len = image_len - addr < chunk ? image_len - addr : chunk;
+        if (send_chunk(fd, &parser, &seq, addr, len, forward) < 0) return -1;
+        fprintf(stderr, "\r%zu/%zu", addr + len, image_len);
+    }
+    for (addr = 0; addr < EE_PAGE; addr += len) {
+        len = EE_PAGE - addr < chunk ? EE_PAGE - addr : chunk;
+        if (send_chunk(fd, &parser, &seq, addr, len, forward) < 0) return -1;
+    }
+    fprintf(stderr, "\rloaded %zu bytes\n", image_len);
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s -o image.bin [-r] file\n"
+                    "       %s [-b baud] [-f] [-r] file device\n", name, name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *outpath = NULL;
+    int baud = 115200;
+    int forward = 0, raw = 0;
+    int fd, opt;
+
+    while ((opt = getopt(argc, argv, "b:o:fr")) != -1) {
+        switch (opt) {
+        case 'b':
+            baud = atoi(optarg);
+            break;
+        case 'o':
+            outpath = optarg;
+            break;
+        case 'f':
+            forward = 1;
+            break;
+        case 'r':
+            raw = 1;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - (outpath ? 1 : 2)) usage(argv[0]);
+
+    if ((raw ? load_raw(argv[optind]) : build(argv[optind])) < 0) return 1;
+
+    if (outpath) {
+        FILE *f = fopen(outpath, "wb");
+
+        if (!f || fwrite(image, 1, image_len, f) != image_len || fclose(f)) {
+            perror(outpath);
+            return 1;
+        }
+        return 0;
+    }
+
+    fd = link_open(argv[optind + 1], baud);
+    if (fd < 0) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    return load(fd, forward) < 0;
+}
@@ -0,0 +1,143 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "link.h"
+
+#define ST_SYNC 0
+#define ST_TYPE 1
+#define ST_SEQ  2
+#define ST_LEN  3
+#define ST_DATA 4
+#define ST_CRC  5
+
+static speed_t baud_flag(int baud) {
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    }
+    return 0;
+}
+
+// Opens a serial device (configured raw 8N1 at baud) or, for a regular file
+// such as a saved capture, just opens it for reading.
+int link_open(const char *path, int baud) {
+    struct termios tio;
+    struct stat st;
+    speed_t speed;
+    int fd;
+
+    if (strcmp(path, "-") == 0) return STDIN_FILENO;
+
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) return open(path, O_RDONLY);
+
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) return -1;
+
+    speed = baud_flag(baud);
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %d\n", baud);
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (tcgetattr(fd, &tio) < 0) {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+unsigned char link_crc8(unsigned char crc, unsigned char byte) {
+    int i;
+
+    crc ^= byte;
+    for (i = 0; i < 8; i++) {
+        if (crc & 0x80) crc = (unsigned char)((crc << 1) ^ TLM_CRC_POLY);
+        else crc <<= 1;
+    }
+    return crc;
+}
+
+void link_reset(struct link_parser *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_SYNC;
+}
+
+int link_feed(struct link_parser *p, unsigned char byte) {
+    switch (p->state) {
+    case ST_SYNC:
+        if (byte != TLM_SYNC) return LINK_TEXT;
+        p->crc = 0;
+        p->got = 0;
+        p->state = ST_TYPE;
+        return LINK_NONE;
+    case ST_TYPE:
+        p->frame.type = byte;
+        p->crc = link_crc8(p->crc, byte);
+        p->state = ST_SEQ;
+        return LINK_NONE;
+    case ST_SEQ:
+        p->frame.seq = byte;
+        p->crc = link_crc8(p->crc, byte);
+        p->state = ST_LEN;
+        return LINK_NONE;
+    case ST_LEN:
+        if (byte > TLM_MAX_PAYLOAD) {
+            p->state = ST_SYNC;
+            return LINK_BADCRC;
+        }
+        p->frame.len = byte;
+        p->crc = link_crc8(p->crc, byte);
+        p->state = byte ? ST_DATA : ST_CRC;
+        return LINK_NONE;
+    case ST_DATA:
+        p->frame.payload[p->got++] = byte;
+        p->crc = link_crc8(p->crc, byte);
+        if (p->got == p->frame.len) p->state = ST_CRC;
+        return LINK_NONE;
+    case ST_CRC:
+        p->state = ST_SYNC;
+        return byte == p->crc ? LINK_FRAME : LINK_BADCRC;
+    }
+    p->state = ST_SYNC;
+    return LINK_NONE;
+}
+
+// Builds a frame in out (at least TLM_MAX_PAYLOAD + 5 bytes), returns its size.
+int link_encode(unsigned char *out, unsigned char type, unsigned char seq,
+                const unsigned char *payload, unsigned char len) {
+    unsigned char crc = 0;
+    int n = 0;
+    int i;
+
+    out[n++] = TLM_SYNC;
+    out[n++] = type;
+    out[n++] = seq;
+    out[n++] = len;
+    for (i = 1; i < n; i++) crc = link_crc8(crc, out[i]);
+    for (i = 0; i < len; i++) {
+        out[n++] = payload[i];
+        crc = link_crc8(crc, payload[i]);
+    }
+    out[n++] = crc;
+    return n;
+}
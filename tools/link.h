@@ -0,0 +1,32 @@
+// Host side of the telemetry link: serial port setup and frame parsing for
+// the format described in ../telemetry_protocol.h.
+
+#include "../telemetry_protocol.h"
+
+struct tlm_frame {
+    unsigned char type;
+    unsigned char seq;
+    unsigned char len;
+    unsigned char payload[TLM_MAX_PAYLOAD];
+};
+
+#define LINK_NONE   0   // byte consumed, no frame yet
+#define LINK_FRAME  1   // frame complete
+#define LINK_TEXT   2   // byte was outside a frame (plain text)
+#define LINK_BADCRC 3   // frame dropped on checksum mismatch
+
+struct link_parser {
+    int state;
+    unsigned char crc;
+    unsigned char got;
+    struct tlm_frame frame;
+};
+
+int link_open(const char *path, int baud);
+
+unsigned char link_crc8(unsigned char crc, unsigned char byte);
+void link_reset(struct link_parser *p);
+int link_feed(struct link_parser *p, unsigned char byte);
+
+int link_encode(unsigned char *out, unsigned char type, unsigned char seq,
+                const unsigned char *payload, unsigned char len);
@@ -0,0 +1,64 @@
+// Generates colorlut.c: the program memory colour tables read by led.asm.
+// Channel values run 0-max (default 15, the range of strip_gradient and of the
+// runs built from it); anything above max is full scale. Row L (0-15) maps a
+// value v to 255 * (v/max)^gamma * L/15: gamma makes the colour values
+// perceptually even, and the level then scales the result linearly, so every
+// level above 0 still shows every colour. Row 16 is the identity (raw
+// output). Rows are 256 bytes and 256 byte aligned so the value is the low
+// byte of the table pointer.
+//
+//   cc -o mklut mklut.c -lm
+//   ./mklut [-g gamma] [-m max] > ../colorlut.c
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define LEVELS  16
+#define ROWS    (LEVELS + 1)
+
+int main(int argc, char **argv) {
+    double gamma = 2.5;
+    int max = 15;
+    int opt, row, v;
+
+    while ((opt = getopt(argc, argv, "g:m:")) != -1) {
+        switch (opt) {
+        case 'g':
+            gamma = atof(optarg);
+            break;
+        case 'm':
+            max = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-g gamma] [-m max]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max < 1 || max > 255) {
+        fprintf(stderr, "max must be 1-255\n");
+        return 2;
+    }
+
+    printf("// Generated by tools/mklut -g %.2f -m %d, do not edit.\n\n", gamma, max);
+    printf("#include \"strip.h\"\n\n");
+    printf("const unsigned char strip_lut[STRIP_LUT_ROWS][256] @ STRIP_LUT_ADDR = {\n");
+    for (row = 0; row < ROWS; row++) {
+        printf("    { // %s %d\n", row < LEVELS ? "level" : "raw", row);
+        for (v = 0; v < 256; v++) {
+            int out = v;
+
+            if (row < LEVELS) {
+                double x = v < max ? (double)v / max : 1.0;
+
+                out = (int)floor(255.0 * pow(x, gamma) * row / (LEVELS - 1) + 0.5);
+            }
+            printf("%s%3d%s", v % 16 == 0 ? "        " : "", out,
+                   v == 255 ? "\n" : v % 16 == 15 ? ",\n" : ",");
+        }
+        printf("    }%s\n", row == ROWS - 1 ? "" : ",");
+    }
+    printf("};\n");
+    return 0;
+}
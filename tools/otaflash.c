@@ -0,0 +1,377 @@
+// Updates a board's application over the air through the boot block loader
+// (see ../bootloader.h). The sender board bridges: every TLM_OTA frame (a
+// command) is sent as one radio payload and answered with a TLM_OTAACK
+// carrying the bootloader's ACK payload. Image data goes as TLM_OTADATA
+// frames, which the sender streams with up to WINDOW payloads queued in its
+// radio; each is answered once it is acked or lost. A lost payload rewinds
+// to itself (go-back-N), and the highest offset any ACK payload reported is
+// the progress. At 115200 baud the UART is the bound, about 9KB/s.
+//
+//   cc -o otaflash otaflash.c link.c
+//   ./otaflash [-b baud] [-r] [-a id] [-n board] app.hex /dev/ttyUSB0
+//
+// app.hex is the application built with the 0x1000 code offset. -n is the
+// target's board id (BL_EE_ID in its data EEPROM, default 0x3B for a board
+// without one); the loader listens on it. Without -r, reset the target by
+// hand; the loader listens for a moment after every reset. -r first asks the
+// running application (radio id -a, default 0x34) to restart into the
+// loader; only the board with that board id takes the request.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "link.h"
+
+// Keep in step with ../bootloader.h
+#define BL_APP_START    0x1000
+#define BL_APP_END      0x8000
+#define BL_DATA         30
+#define BL_ID           0x3B
+#define BL_MSG_ENTER    0x80
+#define BL_MSG_END      0x81
+#define BL_MSG_RUN      0x82
+#define BL_MSG_STATUS   0x83
+#define BL_MSG_REQUEST  0xB0
+#define BL_ACK          0xB1
+#define BL_RECEIVING    0x00
+#define BL_VERIFIED     0x01
+#define BL_BAD_IMAGE    0x02
+#define BL_IDLE         0x03
+#define BL_CRC_POLY     0x1021
+
+#define APP_ID          0x34    // NRF_DEFAULT_ID
+#define WINDOW          3       // TLM_OTADATA frames in flight, the sender's TX FIFO
+#define ANSWER_MS       1000
+#define ENTER_MS        15000
+
+static unsigned char image[BL_APP_END - BL_APP_START];
+static unsigned size;
+
+static int fd;
+static unsigned char board = BL_ID;
+static unsigned char seq;
+static struct link_parser parser;
+
+// Latest bootloader ACK payload
+static int have_ack;
+static unsigned ack_next;
+static int ack_state;
+
+static unsigned long long now_ms(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (unsigned long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static int hexbyte(const char *p) {
+    unsigned v;
+
+    if (sscanf(p, "%2x", &v) != 1) return -1;
+    return v;
+}
+
+static int load_hex(const char *path) {
+    char line[600];
+    unsigned long base = 0;
+    int lineno = 0;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    memset(image, 0xFF, sizeof(image));
+
+    while (fgets(line, sizeof(line), f)) {
+        int len, type, i, sum = 0;
+        unsigned long addr;
+
+        lineno++;
+        if (line[0] != ':') continue;
+        for (i = 1; line[i] && line[i] != '\r' && line[i] != '\n'; i += 2) {
+            int b = hexbyte(line + i);
+
+            if (b < 0) break;
+            sum += b;
+        }
+        len = hexbyte(line + 1);
+        if ((sum & 0xFF) != 0 || len < 0 || i < 11 + len * 2) {
+            fprintf(stderr, "%s:%d: bad record\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+        addr = hexbyte(line + 3) << 8 | hexbyte(line + 5);
+        type = hexbyte(line + 7);
+
+        if (type == 1) break;
+        if (type == 4) {
+            base = (unsigned long)(hexbyte(line + 9) << 8 | hexbyte(line + 11)) << 16;
+            continue;
+        }
+        if (type != 0) continue;
+
+        addr += base;
+        if (addr >= 0x200000) continue;     // ID, config and EEPROM records
+        if (addr < BL_APP_START || addr + len > BL_APP_END) {
+            fprintf(stderr, "%s:%d: data at 0x%06lX is outside the application area "
+                            "(was it built with the 0x1000 code offset?)\n", path, lineno, addr);
+            fclose(f);
+            return -1;
+        }
+        for (i = 0; i < len; i++) image[addr - BL_APP_START + i] = hexbyte(line + 9 + i * 2);
+        if (addr + len - BL_APP_START > size) size = addr + len - BL_APP_START;
+    }
+    fclose(f);
+
+    if (!size) {
+        fprintf(stderr, "%s: no application data\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static unsigned crc16(const unsigned char *p, unsigned n) {
+    unsigned crc = 0xFFFF;
+    int bit;
+
+    while (n--) {
+        crc ^= *p++ << 8;
+        for (bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (crc << 1) ^ BL_CRC_POLY : crc << 1;
+        crc &= 0xFFFF;
+    }
+    return crc;
+}
+
+static int send_frame(int type, unsigned char id, const unsigned char *payload, int len) {
+    unsigned char frame[1 + 32];
+    unsigned char out[TLM_MAX_PAYLOAD + 5];
+    int n;
+
+    frame[0] = id;
+    memcpy(frame + 1, payload, len);
+    n = link_encode(out, type, seq++, frame, len + 1);
+    if (write(fd, out, n) != n) {
+        perror("write");
+        return -1;
+    }
+    return 0;
+}
+
+static int send_payload(unsigned char id, const unsigned char *payload, int len) {
+    return send_frame(TLM_OTA, id, payload, len);
+}
+
+// Next TLM_OTAACK: 1 sent, 0 not acknowledged, -1 no answer
+static int answer(void) {
+    unsigned long long deadline = now_ms() + ANSWER_MS;
+    unsigned char byte;
+    struct timeval tv;
+    fd_set fds;
+
+    for (;;) {
+        long long left = (long long)(deadline - now_ms());
+        const struct tlm_frame *fr = &parser.frame;
+
+        if (left <= 0) return -1;
+        FD_ZERO(&fds);
+        FD_SET(fd, &fds);
+        tv.tv_sec = left / 1000;
+        tv.tv_usec = (left % 1000) * 1000;
+        if (select(fd + 1, &fds, NULL, NULL, &tv) <= 0) return -1;
+        if (read(fd, &byte, 1) != 1) return -1;
+
+        if (link_feed(&parser, byte) != LINK_FRAME || fr->type != TLM_OTAACK || fr->len < 1) continue;
+        if (fr->len >= 5 && fr->payload[1] == BL_ACK) {
+            have_ack = 1;
+            ack_next = fr->payload[2] << 8 | fr->payload[3];
+            ack_state = fr->payload[4];
+        }
+        return fr->payload[0] != 0;
+    }
+}
+
+static int command(unsigned char id, unsigned char cmd) {
+    unsigned char payload[1];
+
+    payload[0] = cmd;
+    if (send_payload(id, payload, 1) < 0) return -1;
+    return answer();
+}
+
+// Sends STATUS until an ACK payload comes back that reflects everything before
+// it (the one answering a packet always shows the state before that packet)
+static int status(void) {
+    int tries, fresh = 0;
+
+    for (tries = 0; tries < 20; tries++) {
+        have_ack = 0;
+        if (command(board, BL_MSG_STATUS) == 1 && have_ack && ++fresh == 2) return 0;
+    }
+    fprintf(stderr, "no status from the loader\n");
+    return -1;
+}
+
+static int enter(int request, unsigned char app_id) {
+    unsigned char payload[4] = { BL_MSG_REQUEST, 'B', 'L', board };
+    unsigned long long deadline = now_ms() + ENTER_MS;
+    int tries;
+
+    if (request) {
+        for (tries = 0; ; tries++) {
+            if (send_payload(app_id, payload, sizeof(payload)) < 0) return -1;
+            if (answer() == 1) break;
+            if (tries == 20) {
+                fprintf(stderr, "application 0x%02X did not take the request\n", app_id);
+                return -1;
+            }
+        }
+    } else {
+        fprintf(stderr, "reset the board now\n");
+    }
+
+    while (now_ms() < deadline) {
+        have_ack = 0;
+        if (command(board, BL_MSG_ENTER) == 1 && command(board, BL_MSG_STATUS) == 1
+                && have_ack && ack_state == BL_RECEIVING && ack_next == 0) {
+            return 0;
+        }
+    }
+    fprintf(stderr, "no loader answered\n");
+    return -1;
+}
+
+static int stream(void) {
+    unsigned char payload[2 + BL_DATA];
+    unsigned inflight[WINDOW];
+    unsigned off = 0, done = 0, n;
+    int head = 0, count = 0, r;
+    int window = 1;     // until the sender is streaming; its UART ring holds one frame
+
+    for (;;) {
+        while (count < window && off < size) {
+            n = size - off < BL_DATA ? size - off : BL_DATA;
+            payload[0] = off >> 8;
+            payload[1] = off & 0xFF;
+            memcpy(payload + 2, image + off, n);
+            if (send_frame(TLM_OTADATA, board, payload, 2 + n) < 0) return -1;
+            inflight[(head + count++) % WINDOW] = off;
+            off += n;
+        }
+
+        if (count == 0) {
+            window = 1;
+            if (status() < 0) return -1;
+            if (ack_state == BL_BAD_IMAGE) break;
+            if (ack_next >= size) return 0;
+            off = ack_next;
+            continue;
+        }
+
+        r = answer();
+        if (r < 0) {
+            // lost track of what is in flight: ask where to go on
+            count = 0;
+            window = 1;
+            if (status() < 0) return -1;
+            off = ack_next;
+            continue;
+        }
+        if (r == 1) window = WINDOW;
+        if (r == 0 && inflight[head] < off) off = inflight[head];
+        head = (head + 1) % WINDOW;
+        count--;
+
+        if (have_ack && ack_state == BL_BAD_IMAGE) break;
+        if (have_ack && ack_state == BL_IDLE) {
+            fprintf(stderr, "\nloader restarted\n");
+            return -1;
+        }
+        // ACK payloads can be a few packets old
+        if (have_ack && ack_next > done) done = ack_next;
+        fprintf(stderr, "\r%u/%u", done, size);
+    }
+    fprintf(stderr, "\nloader rejected the image\n");
+    return -1;
+}
+
+static int finish(void) {
+    unsigned crc = crc16(image, size);
+    unsigned char payload[5];
+    int tries;
+
+    payload[0] = BL_MSG_END;
+    payload[1] = size >> 8;
+    payload[2] = size & 0xFF;
+    payload[3] = crc >> 8;
+    payload[4] = crc & 0xFF;
+
+    for (tries = 0; tries < 20; tries++) {
+        if (send_payload(board, payload, sizeof(payload)) < 0) return -1;
+        if (answer() == 1) break;
+    }
+    if (status() < 0) return -1;
+    if (ack_state != BL_VERIFIED) {
+        fprintf(stderr, "\nimage check failed (crc %04X)\n", crc);
+        return -1;
+    }
+
+    for (tries = 0; tries < 20; tries++) {
+        if (command(board, BL_MSG_RUN) == 1) return 0;
+    }
+    fprintf(stderr, "\nverified, but the loader missed the start command\n");
+    return -1;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-b baud] [-r] [-a id] [-n board] app.hex device\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    unsigned long long start;
+    int baud = 115200;
+    int request = 0;
+    int app_id = APP_ID;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:ra:n:")) != -1) {
+        switch (opt) {
+        case 'b':
+            baud = atoi(optarg);
+            break;
+        case 'r':
+            request = 1;
+            break;
+        case 'a':
+            app_id = strtol(optarg, NULL, 0);
+            break;
+        case 'n':
+            board = strtol(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - 2) usage(argv[0]);
+
+    if (load_hex(argv[optind]) < 0) return 1;
+    fprintf(stderr, "%u bytes, crc %04X\n", size, crc16(image, size));
+
+    fd = link_open(argv[optind + 1], baud);
+    if (fd < 0) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    link_reset(&parser);
+
+    start = now_ms();
+    if (enter(request, app_id) < 0 || stream() < 0 || finish() < 0) return 1;
+    fprintf(stderr, "\rupdated %u bytes in %.1f s\n", size, (now_ms() - start) / 1000.0);
+    return 0;
+}
@@ -0,0 +1,215 @@
+// Pretty-prints the binary telemetry stream from a board (or a saved capture)
+// and optionally logs the decoded output. -r saves the raw byte stream, which
+// is what tracereplay reads back.
+//
+//   cc -o tlm_decode tlm_decode.c link.c
+//   ./tlm_decode [-b baud] [-l logfile] [-r capture] /dev/ttyUSB0
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "link.h"
+
+static const char *reg_names[TLM_NRF_REGISTERS] = {
+    "CONFIG", "EN_AA", "EN_RXADDR", "SETUP_AW", "SETUP_RETR", "RF_CH",
+    "RF_SETUP", "STATUS", "OBSERVE_TX", "RPD", "RX_ADDR_P0", "RX_ADDR_P1",
+    "RX_ADDR_P2", "RX_ADDR_P3", "RX_ADDR_P4", "RX_ADDR_P5", "TX_ADDR",
+    "RX_PW_P0", "RX_PW_P1", "RX_PW_P2", "RX_PW_P3", "RX_PW_P4", "RX_PW_P5",
+    "FIFO_STATUS", "", "", "", "", "DYNPD", "FEATURE",
+};
+
+static FILE *logfile;
+static FILE *rawfile;
+
+static void out(const char *fmt, ...) {
+    struct timeval tv;
+    char stamp[32];
+    va_list ap;
+
+    gettimeofday(&tv, NULL);
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", localtime(&tv.tv_sec));
+
+    printf("%s.%03ld ", stamp, (long)(tv.tv_usec / 1000));
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    fflush(stdout);
+
+    if (logfile) {
+        fprintf(logfile, "%s.%03ld ", stamp, (long)(tv.tv_usec / 1000));
+        va_start(ap, fmt);
+        vfprintf(logfile, fmt, ap);
+        va_end(ap);
+        fflush(logfile);
+    }
+}
+
+static void status_flags(unsigned char status, char *buf) {
+    buf[0] = 0;
+    if (status & 0x40) strcat(buf, " DR");
+    if (status & 0x20) strcat(buf, " DS");
+    if (status & 0x10) strcat(buf, " RT");
+    if (status & 0x01) strcat(buf, " TXF");
+}
+
+static unsigned long trace_stamp(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static void print_frame(const struct tlm_frame *f) {
+    const unsigned char *p = f->payload;
+    char flags[32];
+    int i;
+
+    switch (f->type) {
+    case TLM_REGISTERS:
+        out("registers (%d)\n", f->len - 1);
+        for (i = 1; i < f->len; i++) {
+            int reg = p[0] + i - 1;
+            out("  0x%02X %-12s 0x%02X\n", reg,
+                reg < TLM_NRF_REGISTERS ? reg_names[reg] : "", p[i]);
+        }
+        break;
+    case TLM_STATUS:
+        status_flags(p[0], flags);
+        out("status 0x%02X%s result %d x%d\n", p[0], flags, p[1], p[2]);
+        break;
+    case TLM_COUNTERS:
+        out("counters");
+        for (i = 0; i + 1 < f->len; i += 2) printf(" %u", p[i] | (p[i + 1] << 8));
+        printf("\n");
+        if (logfile) {
+            for (i = 0; i + 1 < f->len; i += 2) fprintf(logfile, " %u", p[i] | (p[i + 1] << 8));
+            fprintf(logfile, "\n");
+        }
+        break;
+    case TLM_PROFILE:
+        out("profile id %d %u ticks (%.1f us)\n", p[0], p[1] | (p[2] << 8),
+            (p[1] | (p[2] << 8)) / 16.0);
+        break;
+    case TLM_TRACE:
+        if (f->len < TLM_TRACE_HEADER) break;
+        out("trace %10.3f ms pipe %d len %d:", trace_stamp(p) / (TLM_TICKS_PER_US * 1000.0),
+            p[4], f->len - TLM_TRACE_HEADER);
+        for (i = TLM_TRACE_HEADER; i < f->len; i++) printf(" %02X", p[i]);
+        printf("\n");
+        if (logfile) {
+            for (i = TLM_TRACE_HEADER; i < f->len; i++) fprintf(logfile, " %02X", p[i]);
+            fprintf(logfile, "\n");
+        }
+        break;
+    case TLM_LOSS:
+        if (f->len < 5) break;
+        out("trace %10.3f ms LOSS %s\n", trace_stamp(p) / (TLM_TICKS_PER_US * 1000.0),
+            p[4] == TLM_LOSS_FIFO_FULL ? "rx fifo full" :
+            p[4] == TLM_LOSS_LENGTH ? "bad length" :
+            p[4] == TLM_LOSS_INJECT ? "inject overrun" : "?");
+        break;
+    case TLM_ROUTES:
+        out("routes");
+        for (i = 0; i + 2 < f->len; i += 3) printf(" %02X<-%02X(%d)", p[i], p[i + 1], p[i + 2]);
+        printf("\n");
+        if (logfile) {
+            for (i = 0; i + 2 < f->len; i += 3)
+                fprintf(logfile, " %02X<-%02X(%d)", p[i], p[i + 1], p[i + 2]);
+            fprintf(logfile, "\n");
+        }
+        break;
+    default:
+        out("type 0x%02X len %d\n", f->type, f->len);
+        break;
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-b baud] [-l logfile] [-r capture] device|capture|-\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    struct link_parser parser;
+    unsigned char buf[256];
+    char text[256];
+    int textlen = 0;
+    int have_seq = 0;
+    unsigned char next_seq = 0;
+    unsigned long frames = 0, dropped = 0, bad = 0;
+    int baud = 115200;
+    int fd, opt, n, i;
+
+    while ((opt = getopt(argc, argv, "b:l:r:")) != -1) {
+        switch (opt) {
+        case 'b':
+            baud = atoi(optarg);
+            break;
+        case 'l':
+            logfile = fopen(optarg, "a");
+            if (!logfile) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'r':
+            rawfile = fopen(optarg, "wb");
+            if (!rawfile) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) usage(argv[0]);
+
+    fd = link_open(argv[optind], baud);
+    if (fd < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    link_reset(&parser);
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        if (rawfile) {
+            fwrite(buf, 1, n, rawfile);
+            fflush(rawfile);
+        }
+        for (i = 0; i < n; i++) {
+            switch (link_feed(&parser, buf[i])) {
+            case LINK_FRAME:
+                frames++;
+                if (have_seq && parser.frame.seq != next_seq) {
+                    dropped += (unsigned char)(parser.frame.seq - next_seq);
+                    out("-- %d frame(s) lost\n", (unsigned char)(parser.frame.seq - next_seq));
+                }
+                have_seq = 1;
+                next_seq = parser.frame.seq + 1;
+                print_frame(&parser.frame);
+                break;
+            case LINK_BADCRC:
+                bad++;
+                out("-- bad frame\n");
+                break;
+            case LINK_TEXT:
+                if (buf[i] == '\n' || textlen == (int)sizeof(text) - 1) {
+                    text[textlen] = 0;
+                    if (textlen) out("text: %s\n", text);
+                    textlen = 0;
+                } else if (buf[i] >= 0x20 && buf[i] < 0x7F) {
+                    text[textlen++] = (char)buf[i];
+                }
+                break;
+            }
+        }
+    }
+
+    fprintf(stderr, "%lu frames, %lu lost, %lu bad\n", frames, dropped, bad);
+    if (logfile) fclose(logfile);
+    if (rawfile) fclose(rawfile);
+    return 0;
+}
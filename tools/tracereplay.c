@@ -0,0 +1,218 @@
+// Replays a sniffer capture (the raw stream saved by tlm_decode -r) into a
+// board's receive path. Every TLM_TRACE payload is sent back as a TLM_INJECT
+// frame, in capture order, spaced by the original Timer0 timestamps divided
+// by the speed factor. The board handles injected payloads exactly like
+// radio ones, so the same traffic can be replayed against every build.
+//
+//   cc -o tracereplay tracereplay.c link.c
+//   ./tracereplay -n capture.bin                       (list only)
+//   ./tracereplay [-b baud] [-x speed] [-p pipe] capture.bin /dev/ttyUSB0
+//
+// -x 1 keeps the original timing, -x 4 runs four times faster and -x 0 sends
+// back-to-back (paced by the serial link itself).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "link.h"
+
+struct record {
+    unsigned long long stamp;   // unwrapped Timer0 ticks
+    unsigned char pipe;
+    unsigned char len;
+    unsigned char data[TLM_MAX_PAYLOAD];
+};
+
+static struct record *records;
+static size_t nrecords, maxrecords;
+
+static unsigned long long now_us(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (unsigned long long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static unsigned long stamp32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+// Timestamps are 32 bit on the wire; stretch them across wraps
+static unsigned long long unwrap(unsigned long stamp) {
+    static unsigned long long base;
+    static unsigned long last;
+    static int started;
+
+    if (started && stamp < last) base += 1ULL << 32;
+    started = 1;
+    last = stamp;
+    return base + stamp;
+}
+
+static int load(const char *path, int pipe_filter) {
+    struct link_parser parser;
+    unsigned char buf[4096];
+    unsigned long losses = 0, bad = 0;
+    FILE *f;
+    size_t n, i;
+
+    f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    link_reset(&parser);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (i = 0; i < n; i++) {
+            const struct tlm_frame *fr = &parser.frame;
+            struct record *r;
+
+            switch (link_feed(&parser, buf[i])) {
+            case LINK_BADCRC:
+                bad++;
+                continue;
+            case LINK_FRAME:
+                break;
+            default:
+                continue;
+            }
+
+            if (fr->type == TLM_LOSS && fr->len >= 5) {
+                losses++;
+                printf("loss at %.3f ms (reason %d)\n",
+                       unwrap(stamp32(fr->payload)) / (TLM_TICKS_PER_US * 1000.0), fr->payload[4]);
+                continue;
+            }
+            if (fr->type != TLM_TRACE || fr->len <= TLM_TRACE_HEADER) continue;
+            if (pipe_filter >= 0 && fr->payload[4] != pipe_filter) continue;
+
+            if (nrecords == maxrecords) {
+                maxrecords = maxrecords ? maxrecords * 2 : 1024;
+                records = realloc(records, maxrecords * sizeof(*records));
+                if (!records) {
+                    perror("realloc");
+                    exit(1);
+                }
+            }
+            r = &records[nrecords++];
+            r->stamp = unwrap(stamp32(fr->payload));
+            r->pipe = fr->payload[4];
+            r->len = fr->len - TLM_TRACE_HEADER;
+            memcpy(r->data, fr->payload + TLM_TRACE_HEADER, r->len);
+        }
+    }
+    fclose(f);
+
+    fprintf(stderr, "%zu payloads, %lu loss markers, %lu bad frames\n", nrecords, losses, bad);
+    return 0;
+}
+
+static void list(void) {
+    size_t i;
+    int j;
+
+    for (i = 0; i < nrecords; i++) {
+        printf("%10.3f ms pipe %d len %2d:", (records[i].stamp - records[0].stamp) /
+               (TLM_TICKS_PER_US * 1000.0), records[i].pipe, records[i].len);
+        for (j = 0; j < records[i].len; j++) printf(" %02X", records[i].data[j]);
+        printf("\n");
+    }
+}
+
+static int send_frame(int fd, unsigned char type, unsigned char seq,
+                      const unsigned char *payload, unsigned char len) {
+    unsigned char out[TLM_MAX_PAYLOAD + 5];
+    int n = link_encode(out, type, seq, payload, len);
+
+    return write(fd, out, n) == n ? 0 : -1;
+}
+
+static int replay(int fd, double speed) {
+    unsigned char payload[TLM_MAX_PAYLOAD];
+    unsigned char seq = 0;
+    unsigned long long start, due;
+    long long late, worst = 0;
+    size_t i;
+
+    // Keep a sniffer build from echoing the replay back
+    payload[0] = 0;
+    if (send_frame(fd, TLM_CAPTURE, seq++, payload, 1) < 0) return -1;
+
+    start = now_us();
+    for (i = 0; i < nrecords; i++) {
+        if (speed > 0) {
+            due = start + (unsigned long long)((records[i].stamp - records[0].stamp) /
+                                               (TLM_TICKS_PER_US * speed));
+            late = (long long)(now_us() - due);
+            if (late < 0) usleep((useconds_t)-late);
+            else if (late > worst) worst = late;
+        }
+
+        payload[0] = records[i].pipe;
+        memcpy(payload + 1, records[i].data, records[i].len);
+        if (send_frame(fd, TLM_INJECT, seq++, payload, records[i].len + 1) < 0) return -1;
+    }
+    tcdrain(fd);
+
+    fprintf(stderr, "replayed %zu payloads in %.3f s", nrecords, (now_us() - start) / 1e6);
+    if (speed > 0) fprintf(stderr, ", worst lag %.3f ms", worst / 1000.0);
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-b baud] [-x speed] [-p pipe] capture device\n"
+                    "       %s -n [-p pipe] capture\n", name, name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    int baud = 115200;
+    int listonly = 0;
+    int pipe_filter = -1;
+    double speed = 1.0;
+    int fd, opt;
+
+    while ((opt = getopt(argc, argv, "b:x:p:n")) != -1) {
+        switch (opt) {
+        case 'b':
+            baud = atoi(optarg);
+            break;
+        case 'x':
+            speed = atof(optarg);
+            break;
+        case 'p':
+            pipe_filter = atoi(optarg);
+            break;
+        case 'n':
+            listonly = 1;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - (listonly ? 1 : 2) || speed < 0) usage(argv[0]);
+
+    if (load(argv[optind], pipe_filter) < 0) return 1;
+    if (listonly) {
+        list();
+        return 0;
+    }
+
+    fd = link_open(argv[optind + 1], baud);
+    if (fd < 0) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    if (replay(fd, speed) < 0) {
+        perror("write");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <xc.h>
+#include "constants.h"
+#include "nRF2401.h"
+#include "telemetry.h"
+#include "sniffer.h"
+#include "txqueue.h"
+
+#define TXQ_SLOTS   (TXQ_CONTROL_DEPTH + TXQ_TELEMETRY_DEPTH)
+
+txq_sender txq_send;
+
+//Control uses slots 0..TXQ_CONTROL_DEPTH-1, telemetry the rest
+unsigned char txq_buf[TXQ_SLOTS][MAX_PAYLOAD];
+unsigned long txq_stamp[TXQ_CONTROL_DEPTH];
+unsigned char txq_head[2];
+unsigned char txq_count[2];
+unsigned char txq_tries = 0;
+
+txq_filler txq_fill = 0;
+unsigned char txq_slice;
+unsigned char txq_sliceTries;
+unsigned char txq_bulkBuf[MAX_PAYLOAD];
+
+unsigned int txq_sent[TXQ_CLASSES];
+unsigned int txq_dropped[TXQ_CLASSES];
+unsigned int txq_latencyMax = 0;
+
+const unsigned char txq_base[2] = {0, TXQ_CONTROL_DEPTH};
+const unsigned char txq_depth[2] = {TXQ_CONTROL_DEPTH, TXQ_TELEMETRY_DEPTH};
+
+void txq_init(txq_sender send) {
+    unsigned char i;
+
+    txq_send = send;
+    txq_fill = 0;
+    txq_tries = 0;
+    for (i=0; i<2; i++) {
+        txq_head[i] = 0;
+        txq_count[i] = 0;
+    }
+    for (i=0; i<TXQ_CLASSES; i++) {
+        txq_sent[i] = 0;
+        txq_dropped[i] = 0;
+    }
+}
+
+//Copies the payload in; a full class refuses (returns 0) rather than
+//pushing out what is already queued
+unsigned char txq_put(unsigned char cls, unsigned char * buf, unsigned char len) {
+    unsigned char slot;
+    unsigned char i;
+
+    if (cls > TXQ_TELEMETRY || len > MAX_PAYLOAD) return 0;
+    if (txq_count[cls] >= txq_depth[cls]) {
+        txq_dropped[cls]++;
+        return 0;
+    }
+
+    i = txq_head[cls] + txq_count[cls];
+    if (i >= txq_depth[cls]) i -= txq_depth[cls];
+    slot = txq_base[cls] + i;
+
+    for (i=0; i<len; i++) {
+        txq_buf[slot][i] = buf[i];
+    }
+    for (; i<MAX_PAYLOAD; i++) {
+        txq_buf[slot][i] = 0;
+    }
+    if (cls == TXQ_CONTROL) txq_stamp[slot] = sniff_timestamp();
+
+    txq_count[cls]++;
+    return 1;
+}
+
+//Starts (or restarts, latest frame wins) the bulk transfer from slice 0
+void txq_bulk(txq_filler fill) {
+    if (txq_fill != 0) txq_dropped[TXQ_BULK]++;
+    txq_fill = fill;
+    txq_slice = 0;
+    txq_sliceTries = 0;
+}
+
+unsigned char txq_pending(void) {
+    return txq_count[TXQ_CONTROL] || txq_count[TXQ_TELEMETRY] || txq_fill != 0;
+}
+
+void txq_pop(unsigned char cls) {
+    if (++txq_head[cls] >= txq_depth[cls]) txq_head[cls] = 0;
+    txq_count[cls]--;
+    txq_tries = 0;
+}
+
+unsigned char txq_sendQueued(unsigned char cls) {
+    unsigned char slot = txq_base[cls] + txq_head[cls];
+    unsigned long latency;
+
+    if (txq_send(txq_buf[slot])) {
+        if (cls == TXQ_CONTROL) {
+            latency = sniff_timestamp() - txq_stamp[slot];
+            if (latency > 0xFFFF) latency = 0xFFFF;
+            if (latency > txq_latencyMax) txq_latencyMax = latency;
+        }
+        txq_sent[cls]++;
+        txq_pop(cls);
+        return 1;
+    }
+
+    if (cls == TXQ_TELEMETRY || ++txq_tries >= TXQ_RETRIES) {
+        txq_dropped[cls]++;
+        txq_pop(cls);
+    }
+    return 0;
+}
+
+//A slice is refilled on every attempt, so the filler always sends current data
+unsigned char txq_sendSlice(void) {
+    if (txq_fill(txq_slice, txq_bulkBuf) == 0) {
+        txq_fill = 0;
+        return 1;
+    }
+
+    if (txq_send(txq_bulkBuf)) {
+        txq_sent[TXQ_BULK]++;
+    } else if (++txq_sliceTries < TXQ_RETRIES) {
+        return 0;
+    } else {
+        txq_dropped[TXQ_BULK]++;
+    }
+
+    txq_slice++;
+    txq_sliceTries = 0;
+    return 1;
+}
+
+//One packet from the highest class that has one; returns nonzero while
+//anything is left to send
+unsigned char txq_service(void) {
+    if (txq_count[TXQ_CONTROL]) {
+        txq_sendQueued(TXQ_CONTROL);
+    } else if (txq_count[TXQ_TELEMETRY]) {
+        txq_sendQueued(TXQ_TELEMETRY);
+    } else if (txq_fill != 0) {
+        txq_sendSlice();
+    }
+    return txq_pending();
+}
+
+void txq_report(void) {
+    unsigned int counters[TXQ_CLASSES*2];
+    unsigned char i;
+
+    for (i=0; i<TXQ_CLASSES; i++) {
+        counters[i*2] = txq_sent[i];
+        counters[i*2+1] = txq_dropped[i];
+    }
+    tlm_sendCounters(counters, TXQ_CLASSES*2);
+    tlm_sendProfile(TXQ_PROFILE_ID, txq_latencyMax);
+    txq_latencyMax = 0;
+}
@@ -0,0 +1,34 @@
+// Transmit queue with three strict priority classes. Control and telemetry
+// payloads are copied into small per-class rings; a bulk transfer is a fill
+// callback walked one slice (payload) at a time, so anything queued in a
+// higher class goes out before the next slice. txq_service() sends exactly
+// one packet, which bounds control latency to one packet time plus the gap
+// until the send task runs again.
+
+#define TXQ_CONTROL         0
+#define TXQ_TELEMETRY       1
+#define TXQ_BULK            2
+#define TXQ_CLASSES         3
+
+#define TXQ_CONTROL_DEPTH   3
+#define TXQ_TELEMETRY_DEPTH 2
+#define TXQ_RETRIES         3       // control and bulk; telemetry is never retried
+
+#define TXQ_PROFILE_ID      0x81    // tlm_sendProfile id for the worst control latency
+
+//Sends one MAX_PAYLOAD buffer, nonzero on success
+typedef unsigned char (*txq_sender)(unsigned char * buf);
+
+//Fills slice n of a bulk transfer into buf, returns 0 past the last slice
+typedef unsigned char (*txq_filler)(unsigned char n, unsigned char * buf);
+
+extern unsigned int txq_sent[TXQ_CLASSES];
+extern unsigned int txq_dropped[TXQ_CLASSES];
+extern unsigned int txq_latencyMax;
+
+void txq_init(txq_sender send);
+unsigned char txq_put(unsigned char cls, unsigned char * buf, unsigned char len);
+void txq_bulk(txq_filler fill);
+unsigned char txq_pending(void);
+unsigned char txq_service(void);
+void txq_report(void);